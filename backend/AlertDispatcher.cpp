@@ -0,0 +1,375 @@
+#include "AlertDispatcher.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+
+AlertConfig defaultAlertConfig() {
+  AlertConfig c;
+  c.repeatWindowMs = 600000;
+  c.correlationWindowMs = 300000;
+  c.groups.push_back(std::vector<uint16_t>{DTC_P0118, DTC_P0562});   // Overheating with low voltage
+  c.queueCapacity = 256;
+  c.heldCapacity = 4096;
+  c.workers = 4;
+  return c;
+}
+
+AlertDispatcher::AlertDispatcher(const AlertConfig& config)
+  : config(config), nextIncidentId(1), started(false), clockMs(0),
+    events(0), repeats(0), flaps(0), correlated(0), opened(0), resolved(0) {}
+
+AlertDispatcher::~AlertDispatcher() {
+  stop();
+}
+
+void AlertDispatcher::addSink(AlertSink* sink, double ratePerSec, double burst, uint8_t kinds) {
+  std::unique_ptr<Sink> s(new Sink());
+  s->sink = sink;
+  s->ratePerSec = ratePerSec;
+  s->burst = std::max(burst, 1.0);
+  s->kinds = kinds;
+  s->tokens = s->burst;
+  s->lastRefillMs = clockMs.load();
+  s->refusedSinceDelivery = 0;
+  unsigned lanes = config.workers > 0 ? config.workers : 1;
+  s->queues.resize(lanes);
+  s->ready = std::vector<std::condition_variable>(lanes);
+  s->queued = 0;
+  s->heldUpdates = 0;
+  s->busyWorkers = 0;
+  s->stopping = false;
+  s->delivered = 0;
+  s->rateLimited = 0;
+  s->coalesced = 0;
+  s->dropped = 0;
+  s->deferred = 0;
+  s->queueFull = 0;
+  s->failed = 0;
+  sinks.push_back(std::move(s));
+}
+
+void AlertDispatcher::start() {
+  if (started) return;
+  started = true;
+  for (const std::unique_ptr<Sink>& s : sinks) {
+    s->stopping = false;
+    for (size_t i = 0; i < s->queues.size(); i++) {
+      s->workers.emplace_back(&AlertDispatcher::workerLoop, this, std::ref(*s), i);
+    }
+  }
+}
+
+void AlertDispatcher::stop() {
+  for (const std::unique_ptr<Sink>& s : sinks) {
+    {
+      std::lock_guard<std::mutex> guard(s->lock);
+      s->stopping = true;
+    }
+    for (std::condition_variable& ready : s->ready) ready.notify_all();
+  }
+  for (const std::unique_ptr<Sink>& s : sinks) {
+    for (std::thread& t : s->workers) t.join();
+    {
+      std::lock_guard<std::mutex> guard(s->lock);
+      s->workers.clear();
+    }
+    s->idle.notify_all();
+  }
+  started = false;
+}
+
+void AlertDispatcher::flush() {
+  for (const std::unique_ptr<Sink>& s : sinks) {
+    std::unique_lock<std::mutex> guard(s->lock);
+    s->idle.wait(guard, [&s]() { return (s->queued == 0 && s->busyWorkers == 0) || s->workers.empty(); });
+  }
+}
+
+int AlertDispatcher::groupOf(uint16_t code) const {
+  for (size_t g = 0; g < config.groups.size(); g++) {
+    const std::vector<uint16_t>& codes = config.groups[g];
+    if (std::find(codes.begin(), codes.end(), code) != codes.end()) return (int)g;
+  }
+  return -1;
+}
+
+void AlertDispatcher::submit(const DtcEvent& e) {
+  events.fetch_add(1, std::memory_order_relaxed);
+  Shard& shard = shards[e.vehicleId % ALERT_SHARDS];
+  std::lock_guard<std::mutex> guard(shard.lock);
+  if (e.action == DTC_ONSET) {
+    onset(shard, e);
+  } else if (e.action == DTC_CLEAR) {
+    clear(shard, e);
+  }
+}
+
+void AlertDispatcher::onset(Shard& shard, const DtcEvent& e) {
+  std::vector<Incident>& list = shard.incidents[e.vehicleId];
+
+  // Same code already in an open incident: a repeat, or a flap if it had cleared
+  for (Incident& inc : list) {
+    for (uint8_t k = 0; k < inc.codeCount; k++) {
+      if (inc.codes[k] != e.code) continue;
+      inc.folded++;
+      if (inc.active[k]) {
+        repeats.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        inc.active[k] = true;
+        inc.activeCount++;
+        flaps.fetch_add(1, std::memory_order_relaxed);
+      }
+      return;
+    }
+  }
+
+  // A recent incident of the same correlation group absorbs it
+  int group = groupOf(e.code);
+  if (group >= 0) {
+    for (Incident& inc : list) {
+      if (inc.group != group || inc.codeCount >= ALERT_MAX_CODES) continue;
+      if (e.timestampMs - inc.openedMs > config.correlationWindowMs) continue;
+      inc.codes[inc.codeCount] = e.code;
+      inc.active[inc.codeCount] = true;
+      inc.codeCount++;
+      inc.activeCount++;
+      correlated.fetch_add(1, std::memory_order_relaxed);
+      notify(inc, e.vehicleId, ALERT_UPDATED, e.timestampMs);
+      return;
+    }
+  }
+
+  Incident inc = Incident();
+  inc.id = nextIncidentId.fetch_add(1, std::memory_order_relaxed);
+  inc.group = group;
+  inc.openedMs = e.timestampMs;
+  inc.codes[0] = e.code;
+  inc.active[0] = true;
+  inc.codeCount = 1;
+  inc.activeCount = 1;
+  list.push_back(inc);
+  opened.fetch_add(1, std::memory_order_relaxed);
+  notify(inc, e.vehicleId, ALERT_OPENED, e.timestampMs);
+}
+
+void AlertDispatcher::clear(Shard& shard, const DtcEvent& e) {
+  auto it = shard.incidents.find(e.vehicleId);
+  if (it == shard.incidents.end()) return;
+  for (Incident& inc : it->second) {
+    for (uint8_t k = 0; k < inc.codeCount; k++) {
+      if (inc.codes[k] != e.code || !inc.active[k]) continue;
+      inc.active[k] = false;
+      if (--inc.activeCount == 0) {
+        inc.quietSinceMs = e.timestampMs;
+        shard.quiet.insert(e.vehicleId);
+      }
+      return;
+    }
+  }
+}
+
+void AlertDispatcher::tick(int64_t nowMs) {
+  if (nowMs > clockMs.load()) clockMs.store(nowMs);
+  for (Shard& shard : shards) {
+    std::lock_guard<std::mutex> guard(shard.lock);
+    for (auto q = shard.quiet.begin(); q != shard.quiet.end();) {
+      uint32_t vehicleId = *q;
+      auto it = shard.incidents.find(vehicleId);
+      bool stillQuiet = false;
+      if (it != shard.incidents.end()) {
+        std::vector<Incident>& list = it->second;
+        for (size_t i = 0; i < list.size();) {
+          Incident& inc = list[i];
+          if (inc.activeCount == 0 && nowMs - inc.quietSinceMs >= config.repeatWindowMs) {
+            resolved.fetch_add(1, std::memory_order_relaxed);
+            notify(inc, vehicleId, ALERT_RESOLVED, nowMs);
+            list[i] = list.back();
+            list.pop_back();
+            continue;
+          }
+          if (inc.activeCount == 0) stillQuiet = true;
+          i++;
+        }
+        if (list.empty()) shard.incidents.erase(it);
+      }
+      q = stillQuiet ? std::next(q) : shard.quiet.erase(q);
+    }
+  }
+  releaseHeld(nowMs);
+}
+
+// Called with the incident's shard locked, so each sink sees an incident's
+// notifications in order. Admission never waits.
+void AlertDispatcher::notify(const Incident& inc, uint32_t vehicleId, uint8_t kind, int64_t timestampMs) {
+  AlertNotification n = AlertNotification();
+  n.incidentId = inc.id;
+  n.vehicleId = vehicleId;
+  n.kind = kind;
+  n.timestampMs = timestampMs;
+  std::copy(inc.codes, inc.codes + inc.codeCount, n.codes);
+  n.codeCount = inc.codeCount;
+  n.folded = inc.folded;
+  for (const std::unique_ptr<Sink>& s : sinks) {
+    if (s->kinds & (1 << kind)) admit(*s, n);
+  }
+}
+
+// Queue n for the sink if it has a token and room and nothing is held ahead
+// of it; otherwise hold it, or drop it if it is an update nothing is held for
+void AlertDispatcher::admit(Sink& s, const AlertNotification& n) {
+  size_t lane = n.incidentId % s.queues.size();
+  bool queued = false;
+  {
+    std::lock_guard<std::mutex> guard(s.lock);
+    refill(s, clockMs.load());
+    bool room = s.queues[lane].size() < config.queueCapacity;
+    if (s.held.empty() && s.tokens >= 1.0 && room) {
+      s.tokens -= 1.0;
+      s.queues[lane].push_back(n);
+      s.queued++;
+      queued = true;
+    } else if (n.kind == ALERT_UPDATED && s.held.empty() && s.tokens < 1.0) {
+      s.refusedSinceDelivery++;
+      s.rateLimited.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      if (!room) s.queueFull.fetch_add(1, std::memory_order_relaxed);
+      hold(s, n);
+    }
+  }
+  if (queued) s.ready[lane].notify_one();
+}
+
+// Called with the sink locked. Updates give way so that held stays within
+// heldCapacity; openings and resolutions are always kept.
+void AlertDispatcher::hold(Sink& s, const AlertNotification& n) {
+  if (n.kind == ALERT_UPDATED || n.kind == ALERT_RESOLVED) {
+    // A later notification of the incident carries the held update's codes
+    for (auto it = s.held.begin(); it != s.held.end(); ++it) {
+      if (it->kind != ALERT_UPDATED || it->incidentId != n.incidentId) continue;
+      s.coalesced.fetch_add(1, std::memory_order_relaxed);
+      s.refusedSinceDelivery++;
+      if (n.kind == ALERT_UPDATED) {
+        *it = n;
+        return;
+      }
+      s.held.erase(it);
+      s.heldUpdates--;
+      break;
+    }
+  }
+  if (s.held.size() >= config.heldCapacity) {
+    if (n.kind == ALERT_UPDATED) {
+      s.dropped.fetch_add(1, std::memory_order_relaxed);
+      s.refusedSinceDelivery++;
+      return;
+    }
+    for (auto it = s.held.begin(); s.heldUpdates > 0 && it != s.held.end(); ++it) {
+      if (it->kind != ALERT_UPDATED) continue;
+      s.held.erase(it);
+      s.heldUpdates--;
+      s.dropped.fetch_add(1, std::memory_order_relaxed);
+      s.refusedSinceDelivery++;
+      break;
+    }
+  }
+  s.held.push_back(n);
+  if (n.kind == ALERT_UPDATED) s.heldUpdates++;
+  s.deferred.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Called with the sink locked
+void AlertDispatcher::refill(Sink& s, int64_t nowMs) {
+  if (nowMs <= s.lastRefillMs) return;
+  s.tokens = std::min(s.burst, s.tokens + (nowMs - s.lastRefillMs) * s.ratePerSec / 1000);
+  s.lastRefillMs = nowMs;
+}
+
+void AlertDispatcher::releaseHeld(int64_t nowMs) {
+  for (const std::unique_ptr<Sink>& s : sinks) {
+    size_t released = 0;
+    {
+      std::lock_guard<std::mutex> guard(s->lock);
+      refill(*s, nowMs);
+      // Oldest first: stop at the first one whose worker has no room
+      while (!s->held.empty() && s->tokens >= 1.0) {
+        const AlertNotification& n = s->held.front();
+        std::deque<AlertNotification>& queue = s->queues[n.incidentId % s->queues.size()];
+        if (queue.size() >= config.queueCapacity) break;
+        s->tokens -= 1.0;
+        if (n.kind == ALERT_UPDATED) s->heldUpdates--;
+        queue.push_back(n);
+        s->held.pop_front();
+        s->queued++;
+        released++;
+      }
+    }
+    if (released > 0) {
+      for (std::condition_variable& ready : s->ready) ready.notify_one();
+    }
+  }
+}
+
+void AlertDispatcher::workerLoop(Sink& s, size_t lane) {
+  std::deque<AlertNotification>& queue = s.queues[lane];
+  for (;;) {
+    AlertNotification n;
+    {
+      std::unique_lock<std::mutex> guard(s.lock);
+      s.ready[lane].wait(guard, [&s, &queue]() { return s.stopping || !queue.empty(); });
+      if (queue.empty()) return;   // Stopping and drained
+      n = queue.front();
+      queue.pop_front();
+      s.queued--;
+      n.rateLimitedBefore = s.refusedSinceDelivery;
+      s.refusedSinceDelivery = 0;
+      s.busyWorkers++;
+    }
+    if (s.sink->deliver(n)) {
+      s.delivered.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      s.failed.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+      std::lock_guard<std::mutex> guard(s.lock);
+      if (--s.busyWorkers == 0 && s.queued == 0) s.idle.notify_all();
+    }
+  }
+}
+
+AlertStats AlertDispatcher::stats() const {
+  AlertStats s;
+  s.events = events.load();
+  s.repeats = repeats.load();
+  s.flaps = flaps.load();
+  s.correlated = correlated.load();
+  s.opened = opened.load();
+  s.resolved = resolved.load();
+  return s;
+}
+
+SinkStats AlertDispatcher::sinkStats(size_t sink) const {
+  SinkStats s = SinkStats();
+  if (sink >= sinks.size()) return s;
+  s.delivered = sinks[sink]->delivered.load();
+  s.rateLimited = sinks[sink]->rateLimited.load();
+  s.coalesced = sinks[sink]->coalesced.load();
+  s.dropped = sinks[sink]->dropped.load();
+  s.deferred = sinks[sink]->deferred.load();
+  s.queueFull = sinks[sink]->queueFull.load();
+  s.failed = sinks[sink]->failed.load();
+  {
+    std::lock_guard<std::mutex> guard(sinks[sink]->lock);
+    s.pending = sinks[sink]->held.size();
+  }
+  return s;
+}
+
+size_t AlertDispatcher::openIncidents() const {
+  size_t total = 0;
+  for (const Shard& shard : shards) {
+    std::lock_guard<std::mutex> guard(shard.lock);
+    for (const auto& entry : shard.incidents) total += entry.second.size();
+  }
+  return total;
+}
@@ -0,0 +1,218 @@
+#ifndef ALERT_DISPATCHER_H
+#define ALERT_DISPATCHER_H
+
+// Fleet-wide alert dispatch from DTC onset/clear events.
+// Devices repeat a fault's alert every cycle while it persists; this turns
+// that stream into incidents. Events are keyed by vehicle and code:
+// repeats of an active code, and a code that clears and comes back within
+// the repeat window, fold into the open incident. Codes in the same
+// correlation group (P0118 overheating with P0562 low voltage by default)
+// that start close together on one vehicle join a single incident. An
+// incident resolves once all its codes have stayed clear for the repeat
+// window.
+//
+// Event processing runs on the caller's thread under per-shard locks. Each
+// sink has its own worker threads, each with a bounded queue fed by
+// incident, so a slow sink only backs up itself and sees every incident's
+// notifications in order. A notification is admitted to each subscribed sink under
+// that sink's rate limit (run on event time as given to tick()) without
+// waiting: if the sink has no token, or its queue is full, an opening or
+// resolution is held for that sink and sent, oldest first, once tokens and
+// room return. Updates are never worth waiting for, since the incident's
+// next notification carries its codes: one refused while nothing is held is
+// only counted and reported with the sink's next delivery; one queued
+// behind held notifications replaces an update of the same incident already
+// held, is dropped by a held resolution of its incident, and is dropped
+// (oldest first) to keep the held list within heldCapacity. Only openings
+// and resolutions can take the held list past that cap.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "DtcCodes.h"
+#include "TelemetryLog.h"     // DTC_ONSET, DTC_CLEAR
+
+#define ALERT_SHARDS             64
+#define ALERT_MAX_CODES          4       // Codes tracked per incident
+
+// Notification kinds; sinks subscribe with a mask of (1 << kind)
+#define ALERT_OPENED    0
+#define ALERT_UPDATED   1    // A correlated code joined the incident
+#define ALERT_RESOLVED  2
+#define ALERT_ALL_KINDS 0x07
+
+struct DtcEvent {
+  uint32_t vehicleId;
+  int64_t timestampMs;
+  uint16_t code;        // Packed, see encodeDTC()
+  int8_t action;        // DTC_ONSET or DTC_CLEAR
+};
+
+struct AlertNotification {
+  uint64_t incidentId;
+  uint32_t vehicleId;
+  uint8_t kind;
+  int64_t timestampMs;
+  uint16_t codes[ALERT_MAX_CODES];
+  uint8_t codeCount;
+  uint32_t folded;            // Repeats and flaps absorbed by the incident so far
+  uint32_t rateLimitedBefore; // Set per sink: updates its rate limit refused since its last delivery
+};
+
+// A notification channel (SMS gateway, e-mail, dashboard). deliver() is
+// called from several worker threads at once and may block.
+class AlertSink {
+public:
+  virtual ~AlertSink() {}
+  virtual const char* name() const = 0;
+  virtual bool deliver(const AlertNotification& n) = 0;
+};
+
+struct AlertConfig {
+  int64_t repeatWindowMs;         // Flaps inside this fold into the incident; also the resolve delay
+  int64_t correlationWindowMs;    // A grouped code joins an incident opened this recently
+  std::vector<std::vector<uint16_t>> groups;
+  size_t queueCapacity;           // Per worker: notifications waiting before more are held
+  size_t heldCapacity;            // Per sink: held notifications before updates are dropped
+  unsigned workers;               // Per sink
+};
+
+// 10-minute repeat window, 5-minute correlation window, {P0118, P0562},
+// per sink 4 workers with 256 queued each and 4096 held
+AlertConfig defaultAlertConfig();
+
+struct AlertStats {
+  uint64_t events;
+  uint64_t repeats;            // Onsets of a code that was already active
+  uint64_t flaps;              // Onsets of a code that cleared within the repeat window
+  uint64_t correlated;         // Onsets that joined an incident of their group
+  uint64_t opened;
+  uint64_t resolved;
+};
+
+struct SinkStats {
+  uint64_t delivered;
+  uint64_t rateLimited;        // Updates refused by the rate limit and not sent
+  uint64_t coalesced;          // Held updates replaced by a later notification of their incident
+  uint64_t dropped;            // Held updates dropped to stay within heldCapacity
+  uint64_t deferred;           // Notifications held at first because of the rate limit or a full queue
+  uint64_t queueFull;          // Of those, held because the sink's queue was full
+  uint64_t pending;            // Held notifications still waiting for a token or room
+  uint64_t failed;
+};
+
+class AlertDispatcher {
+public:
+  explicit AlertDispatcher(const AlertConfig& config = defaultAlertConfig());
+  ~AlertDispatcher();
+
+  // ratePerSec/burst: token bucket for this sink. kinds: mask of (1 << ALERT_*).
+  // Add sinks before start() and submit().
+  void addSink(AlertSink* sink, double ratePerSec, double burst, uint8_t kinds = ALERT_ALL_KINDS);
+
+  void start();
+
+  // Deliver what is queued, then stop the workers. Held notifications stay
+  // pending (see SinkStats) until a later tick().
+  void stop();
+
+  // Wait until every queued notification has been handed to its sink
+  void flush();
+
+  // Process one event. Safe from any number of threads, and never waits for
+  // a sink; each vehicle's events should arrive in time order.
+  void submit(const DtcEvent& e);
+
+  // Resolve incidents whose codes have all been clear for the repeat window,
+  // refill the sinks' rate limits to nowMs and queue held notifications they
+  // now have tokens and room for. Call periodically with the current event time.
+  void tick(int64_t nowMs);
+
+  AlertStats stats() const;
+  SinkStats sinkStats(size_t sink) const;
+  size_t openIncidents() const;
+
+private:
+  struct Incident {
+    uint64_t id;
+    int group;                     // -1: ungrouped, one code only
+    int64_t openedMs;
+    int64_t quietSinceMs;          // All codes clear since; valid while activeCount == 0
+    uint16_t codes[ALERT_MAX_CODES];
+    bool active[ALERT_MAX_CODES];
+    uint8_t codeCount;
+    uint8_t activeCount;
+    uint32_t folded;
+  };
+
+  struct Shard {
+    mutable std::mutex lock;
+    std::unordered_map<uint32_t, std::vector<Incident>> incidents;   // By vehicle
+    std::unordered_set<uint32_t> quiet;    // Vehicles with an incident waiting to resolve
+  };
+
+  // Everything but the counters is under lock. It is only ever held for a
+  // few operations, never across deliver(), so taking it under a shard
+  // lock is safe.
+  struct Sink {
+    AlertSink* sink;
+    double ratePerSec;
+    double burst;
+    uint8_t kinds;
+    mutable std::mutex lock;
+    double tokens;
+    int64_t lastRefillMs;               // Event time
+    uint32_t refusedSinceDelivery;
+    std::vector<std::deque<AlertNotification>> queues; // Per worker, token paid
+    std::vector<std::condition_variable> ready;        // Per worker
+    size_t queued;                       // Across queues
+    std::deque<AlertNotification> held;  // Waiting for a token or room, oldest first
+    size_t heldUpdates;                  // Updates among held
+    unsigned busyWorkers;
+    bool stopping;
+    std::condition_variable idle;
+    std::vector<std::thread> workers;
+    std::atomic<uint64_t> delivered;
+    std::atomic<uint64_t> rateLimited;
+    std::atomic<uint64_t> coalesced;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> deferred;
+    std::atomic<uint64_t> queueFull;
+    std::atomic<uint64_t> failed;
+  };
+
+  int groupOf(uint16_t code) const;
+  void onset(Shard& shard, const DtcEvent& e);
+  void clear(Shard& shard, const DtcEvent& e);
+  void notify(const Incident& incident, uint32_t vehicleId, uint8_t kind, int64_t timestampMs);
+  void admit(Sink& s, const AlertNotification& n);
+  void hold(Sink& s, const AlertNotification& n);
+  void refill(Sink& s, int64_t nowMs);
+  void releaseHeld(int64_t nowMs);
+  void workerLoop(Sink& s, size_t lane);
+
+  AlertConfig config;
+  Shard shards[ALERT_SHARDS];
+  std::vector<std::unique_ptr<Sink>> sinks;
+  std::atomic<uint64_t> nextIncidentId;
+  bool started;
+  std::atomic<int64_t> clockMs;    // Latest tick() time, drives the rate limits
+
+  std::atomic<uint64_t> events;
+  std::atomic<uint64_t> repeats;
+  std::atomic<uint64_t> flaps;
+  std::atomic<uint64_t> correlated;
+  std::atomic<uint64_t> opened;
+  std::atomic<uint64_t> resolved;
+};
+
+#endif
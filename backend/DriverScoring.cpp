@@ -0,0 +1,81 @@
+#include "DriverScoring.h"
+
+// Stateless per-sample checks (slopes, time-in-state, distance) run as flat
+// reductions the compiler can vectorize. Only the minimum-duration episodes
+// need a run length, which is carried in a short scalar pass.
+
+DriverTripStats scoreTrip(const uint16_t* speedKmh, const uint8_t* throttlePct,
+                          const uint16_t* rpm, size_t n, uint32_t sampleIntervalMs) {
+  DriverTripStats s = DriverTripStats();
+  if (n < 2) return s;
+
+  const int64_t dt = sampleIntervalMs;
+  const bool rateValid = dt > 0 && dt <= MAX_SAMPLE_GAP_MS;
+  const int64_t accelLimit = (int64_t)HARSH_ACCEL_KMH_PER_S * dt;
+  const int64_t brakeLimit = (int64_t)HARSH_BRAKE_KMH_PER_S * dt;
+
+  // Pass 1: vectorizable reductions over samples 1..n-1 (sample 0 only primes the engine)
+  uint64_t speedSum = 0;
+  uint32_t moving = 0, idle = 0, overRev = 0, speeding = 0;
+  uint32_t accelOnsets = 0, brakeOnsets = 0;
+  for (size_t i = 1; i < n; i++) {
+    int64_t dv = (int64_t)speedKmh[i] - speedKmh[i - 1];
+    uint32_t accel = rateValid & (dv * 1000 > accelLimit);
+    uint32_t brake = rateValid & (-dv * 1000 > brakeLimit);
+    uint32_t prevA = 0, prevB = 0;
+    if (i >= 2) {
+      int64_t pdv = (int64_t)speedKmh[i - 1] - speedKmh[i - 2];
+      prevA = rateValid & (pdv * 1000 > accelLimit);
+      prevB = rateValid & (-pdv * 1000 > brakeLimit);
+    }
+    accelOnsets += accel & ~prevA & 1u;
+    brakeOnsets += brake & ~prevB & 1u;
+
+    speedSum += speedKmh[i];
+    moving += speedKmh[i] > 0;
+    idle += (speedKmh[i] == 0) & (rpm[i] >= IDLE_RPM_MIN) & (throttlePct[i] < IDLE_THROTTLE_MAX);
+    overRev += rpm[i] > OVER_REV_RPM;
+    speeding += speedKmh[i] > SPEED_LIMIT_KMH;
+  }
+
+  s.durationMs = (uint32_t)((n - 1) * dt);
+  s.drivingMs = (uint32_t)(moving * dt);
+  s.distanceM = (uint32_t)(speedSum * (uint64_t)dt / 3600);
+  s.idleMs = (uint32_t)(idle * dt);
+  s.overRevMs = (uint32_t)(overRev * dt);
+  s.speedingMs = (uint32_t)(speeding * dt);
+  s.harshAccelCount = accelOnsets;
+  s.harshBrakeCount = brakeOnsets;
+
+  // Pass 2: run lengths for episodes that must persist before they count
+  uint32_t overRevRun = 0, idleRun = 0, speedingRun = 0;
+  for (size_t i = 1; i < n; i++) {
+    bool isOverRev = rpm[i] > OVER_REV_RPM;
+    bool isIdle = speedKmh[i] == 0 && rpm[i] >= IDLE_RPM_MIN && throttlePct[i] < IDLE_THROTTLE_MAX;
+    bool isSpeeding = speedKmh[i] > SPEED_LIMIT_KMH;
+
+    overRevRun = isOverRev ? overRevRun + (uint32_t)dt : 0;
+    idleRun = isIdle ? idleRun + (uint32_t)dt : 0;
+    speedingRun = isSpeeding ? speedingRun + (uint32_t)dt : 0;
+
+    // Count on the sample where the run first reaches its minimum duration
+    s.overRevCount += isOverRev && overRevRun >= OVER_REV_MIN_MS && overRevRun - dt < OVER_REV_MIN_MS;
+    s.idleCount += isIdle && idleRun >= EXCESSIVE_IDLE_MS && idleRun - dt < EXCESSIVE_IDLE_MS;
+    s.speedingCount += isSpeeding && speedingRun >= SPEEDING_MIN_MS && speedingRun - dt < SPEEDING_MIN_MS;
+  }
+
+  return s;
+}
+
+void scoreTrips(const TripBatch& batch, DriverTripStats* stats, uint8_t* scores) {
+  const long long tripCount = (long long)batch.tripCount;
+
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (long long t = 0; t < tripCount; t++) {
+    uint64_t begin = batch.tripOffsets[t];
+    uint64_t end = batch.tripOffsets[t + 1];
+    stats[t] = scoreTrip(batch.speedKmh + begin, batch.throttlePct + begin,
+                         batch.rpm + begin, (size_t)(end - begin), batch.sampleIntervalMs);
+    scores[t] = driverScore(stats[t]);
+  }
+}
@@ -0,0 +1,32 @@
+#ifndef DRIVER_SCORING_H
+#define DRIVER_SCORING_H
+
+// Host-side batch driver scoring.
+// Scores stored trips with the same thresholds and score formula as the
+// on-device DriverBehavior engine, over columnar (structure-of-arrays) data
+// so the per-sample checks auto-vectorize.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../codes/src/DriverBehavior.h"
+
+// Columnar trip samples. Trip t covers samples [tripOffsets[t], tripOffsets[t + 1]).
+struct TripBatch {
+  const uint16_t* speedKmh;
+  const uint8_t* throttlePct;
+  const uint16_t* rpm;
+  const uint64_t* tripOffsets;   // tripCount + 1 entries
+  size_t tripCount;
+  uint32_t sampleIntervalMs;     // Fixed logging interval of the stored trips
+};
+
+// Score every trip in the batch. stats and scores must hold tripCount entries.
+// Trips are scored in parallel when built with OpenMP.
+void scoreTrips(const TripBatch& batch, DriverTripStats* stats, uint8_t* scores);
+
+// Score a single trip of n samples
+DriverTripStats scoreTrip(const uint16_t* speedKmh, const uint8_t* throttlePct,
+                          const uint16_t* rpm, size_t n, uint32_t sampleIntervalMs);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef DTC_CODES_H
+#define DTC_CODES_H
+
+// Packed DTC codes raised by checkAndGenerateDTCs() on the device, as they
+// arrive in telemetry (see encodeDTC()).
+
+#define DTC_P0118 0x0118   // Engine coolant temperature circuit high
+#define DTC_P0562 0x0562   // System voltage low
+#define DTC_P0123 0x0123   // Throttle position sensor high input
+
+#endif
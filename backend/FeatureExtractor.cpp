@@ -0,0 +1,266 @@
+#include "FeatureExtractor.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+void FeatureTable::resize(size_t n) {
+  vehicleId.resize(n);
+  windowStartMs.resize(n);
+  sampleCount.resize(n);
+  coolantMean.resize(n);
+  coolantVar.resize(n);
+  voltageMean.resize(n);
+  voltageVar.resize(n);
+  rpmMean.resize(n);
+  rpmVar.resize(n);
+  coolantHighMs.resize(n);
+  voltageLowMs.resize(n);
+  voltageDipCount.resize(n);
+  dtcOnsetCount.resize(n);
+  dtcClearCount.resize(n);
+  dtcClearLatencyMeanMs.resize(n);
+  dtcClearLatencyMaxMs.resize(n);
+}
+
+// One vehicle/window pair and the samples it covers
+struct WindowTask {
+  uint32_t vehicleId;
+  int64_t windowStartMs;
+  int64_t windowEndMs;
+  size_t begin;
+  size_t end;
+  bool carryIn;      // Sample begin - 1 belongs to the vehicle; its hold may reach into the window
+};
+
+static int64_t floorDiv(int64_t a, int64_t b) {
+  int64_t q = a / b;
+  return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+// Mean and variance, shifted by the first value to keep the single-pass sums stable
+static void meanVariance(const float* x, size_t n, float& mean, float& var) {
+  const float shift = x[0];
+  double sum = 0.0, sumSq = 0.0;
+  #pragma omp simd reduction(+:sum, sumSq)
+  for (size_t i = 0; i < n; i++) {
+    double d = (double)(x[i] - shift);
+    sum += d;
+    sumSq += d * d;
+  }
+  double m = sum / n;
+  mean = (float)(m + shift);
+  var = (float)std::max(0.0, sumSq / n - m * m);
+}
+
+void extractFeatures(const TelemetryLog& log, int64_t windowMs, int64_t hopMs, FeatureTable& table) {
+  const size_t n = log.size();
+  table.resize(0);
+  if (n == 0 || windowMs <= 0 || hopMs <= 0) return;
+
+  const uint32_t* vehicle = log.vehicleId.data();
+  const int64_t* ts = log.timestampMs.data();
+
+  // Vehicle boundaries
+  std::vector<size_t> vehicleStart;
+  for (size_t i = 0; i < n; i++) {
+    if (i == 0 || vehicle[i] != vehicle[i - 1]) vehicleStart.push_back(i);
+  }
+  vehicleStart.push_back(n);
+  const long long vehicleCount = (long long)vehicleStart.size() - 1;
+
+  // Per-sample derived columns that depend on the vehicle's history:
+  // hold time until the next sample, and onset-to-clear latency on clear events.
+  std::vector<int64_t> holdMs(n);
+  std::vector<int64_t> clearLatencyMs(n);
+  std::vector<std::vector<WindowTask>> vehicleTasks(vehicleCount);
+
+  #pragma omp parallel for schedule(dynamic, 16)
+  for (long long v = 0; v < vehicleCount; v++) {
+    size_t begin = vehicleStart[v];
+    size_t end = vehicleStart[v + 1];
+
+    for (size_t i = begin; i + 1 < end; i++) {
+      holdMs[i] = std::min<int64_t>(ts[i + 1] - ts[i], FEATURE_MAX_HOLD_MS);
+    }
+    holdMs[end - 1] = 0;
+
+    // Codes currently open on this vehicle and when they started; usually zero or one
+    std::vector<std::pair<uint16_t, int64_t>> open;
+    for (size_t i = begin; i < end; i++) {
+      clearLatencyMs[i] = -1;
+      if (log.dtcAction[i] == DTC_NONE) continue;
+
+      uint16_t code = log.dtcCode[i];
+      size_t slot = 0;
+      while (slot < open.size() && open[slot].first != code) slot++;
+      if (log.dtcAction[i] == DTC_ONSET) {
+        if (slot == open.size()) open.push_back(std::make_pair(code, ts[i]));
+      } else if (slot < open.size()) {
+        clearLatencyMs[i] = ts[i] - open[slot].second;
+        open[slot] = open.back();
+        open.pop_back();
+      }
+    }
+
+    // Windows start every hopMs; a sample at t is in those starting in (t - windowMs, t].
+    // lo and hi only move forward, and windows with no samples are skipped.
+    std::vector<WindowTask>& tasks = vehicleTasks[v];
+    size_t lo = begin, hi = begin;
+    int64_t k = floorDiv(ts[begin] - windowMs, hopMs) + 1;
+    while (lo < end) {
+      int64_t start = k * hopMs;
+      while (lo < end && ts[lo] < start) lo++;
+      if (lo == end) break;
+      if (ts[lo] >= start + windowMs) {
+        k = floorDiv(ts[lo] - windowMs, hopMs) + 1;
+        continue;
+      }
+      if (hi < lo) hi = lo;
+      while (hi < end && ts[hi] < start + windowMs) hi++;
+      tasks.push_back(WindowTask{vehicle[begin], start, start + windowMs, lo, hi, lo > begin});
+      k++;
+    }
+  }
+
+  std::vector<WindowTask> tasks;
+  for (const std::vector<WindowTask>& t : vehicleTasks) {
+    tasks.insert(tasks.end(), t.begin(), t.end());
+  }
+  table.resize(tasks.size());
+
+  const long long taskCount = (long long)tasks.size();
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (long long t = 0; t < taskCount; t++) {
+    const WindowTask& task = tasks[t];
+    const size_t b = task.begin;
+    const size_t count = task.end - task.begin;
+    const float* coolant = log.coolantTemp.data() + b;
+    const float* voltage = log.batteryVoltage.data() + b;
+    const int64_t* time = ts + b;
+    const int64_t* hold = holdMs.data() + b;
+    const int64_t* latency = clearLatencyMs.data() + b;
+    const int8_t* action = log.dtcAction.data() + b;
+    const int64_t windowEnd = task.windowEndMs;
+
+    table.vehicleId[t] = task.vehicleId;
+    table.windowStartMs[t] = task.windowStartMs;
+    table.sampleCount[t] = (uint32_t)count;
+    meanVariance(coolant, count, table.coolantMean[t], table.coolantVar[t]);
+    meanVariance(voltage, count, table.voltageMean[t], table.voltageVar[t]);
+    meanVariance(log.rpm.data() + b, count, table.rpmMean[t], table.rpmVar[t]);
+
+    // A dip is a sample below the limit whose predecessor (same vehicle) was not
+    float before = task.carryIn ? log.batteryVoltage[b - 1] : FEATURE_VOLTAGE_LOW_V;
+
+    // Time past a limit is split at the window edges: the previous sample's
+    // hold counts from the window start, and the last hold stops at its end.
+    int64_t highMs = 0, lowMs = 0, latencySum = 0, latencyMax = 0;
+    if (task.carryIn) {
+      int64_t carried = std::max<int64_t>(0, ts[b - 1] + holdMs[b - 1] - task.windowStartMs);
+      highMs += log.coolantTemp[b - 1] > FEATURE_COOLANT_HIGH_C ? carried : 0;
+      lowMs += before < FEATURE_VOLTAGE_LOW_V ? carried : 0;
+    }
+    uint32_t dips = 0, onsets = 0, clears = 0;
+    #pragma omp simd reduction(+:highMs, lowMs, latencySum, dips, onsets, clears) reduction(max:latencyMax)
+    for (size_t i = 0; i < count; i++) {
+      float prev = i == 0 ? before : voltage[i - 1];
+      int64_t inWindow = std::min(hold[i], windowEnd - time[i]);
+      highMs += coolant[i] > FEATURE_COOLANT_HIGH_C ? inWindow : 0;
+      lowMs += voltage[i] < FEATURE_VOLTAGE_LOW_V ? inWindow : 0;
+      dips += (voltage[i] < FEATURE_VOLTAGE_LOW_V) & (prev >= FEATURE_VOLTAGE_LOW_V);
+      onsets += action[i] == DTC_ONSET;
+      clears += latency[i] >= 0;
+      latencySum += latency[i] >= 0 ? latency[i] : 0;
+      latencyMax = std::max(latencyMax, latency[i]);
+    }
+
+    table.coolantHighMs[t] = highMs;
+    table.voltageLowMs[t] = lowMs;
+    table.voltageDipCount[t] = dips;
+    table.dtcOnsetCount[t] = onsets;
+    table.dtcClearCount[t] = clears;
+    table.dtcClearLatencyMeanMs[t] = clears ? (float)latencySum / clears : 0.0f;
+    table.dtcClearLatencyMaxMs[t] = latencyMax;
+  }
+}
+
+#define COLUMN_U32 1
+#define COLUMN_I64 2
+#define COLUMN_F32 3
+
+struct ColumnDescriptor {
+  char name[48];
+  uint32_t type;
+  uint32_t reserved;
+  uint64_t offset;
+};
+
+struct ColumnSource {
+  const char* name;
+  uint32_t type;
+  const void* data;
+  size_t elementSize;
+};
+
+bool writeFeatureFile(const std::string& path, const FeatureTable& table, std::string& error) {
+  const ColumnSource columns[] = {
+    {"vehicle_id", COLUMN_U32, table.vehicleId.data(), 4},
+    {"window_start_ms", COLUMN_I64, table.windowStartMs.data(), 8},
+    {"sample_count", COLUMN_U32, table.sampleCount.data(), 4},
+    {"coolant_mean", COLUMN_F32, table.coolantMean.data(), 4},
+    {"coolant_var", COLUMN_F32, table.coolantVar.data(), 4},
+    {"voltage_mean", COLUMN_F32, table.voltageMean.data(), 4},
+    {"voltage_var", COLUMN_F32, table.voltageVar.data(), 4},
+    {"rpm_mean", COLUMN_F32, table.rpmMean.data(), 4},
+    {"rpm_var", COLUMN_F32, table.rpmVar.data(), 4},
+    {"coolant_high_ms", COLUMN_I64, table.coolantHighMs.data(), 8},
+    {"voltage_low_ms", COLUMN_I64, table.voltageLowMs.data(), 8},
+    {"voltage_dip_count", COLUMN_U32, table.voltageDipCount.data(), 4},
+    {"dtc_onset_count", COLUMN_U32, table.dtcOnsetCount.data(), 4},
+    {"dtc_clear_count", COLUMN_U32, table.dtcClearCount.data(), 4},
+    {"dtc_clear_latency_mean_ms", COLUMN_F32, table.dtcClearLatencyMeanMs.data(), 4},
+    {"dtc_clear_latency_max_ms", COLUMN_I64, table.dtcClearLatencyMaxMs.data(), 8},
+  };
+  const uint32_t columnCount = sizeof(columns) / sizeof(columns[0]);
+  const uint64_t rows = table.size();
+
+  auto align64 = [](uint64_t x) { return (x + 63) & ~(uint64_t)63; };
+
+  std::vector<ColumnDescriptor> descriptors(columnCount);
+  uint64_t offset = align64(24 + sizeof(ColumnDescriptor) * columnCount);
+  for (uint32_t c = 0; c < columnCount; c++) {
+    std::memset(&descriptors[c], 0, sizeof(ColumnDescriptor));
+    std::strncpy(descriptors[c].name, columns[c].name, sizeof(descriptors[c].name) - 1);
+    descriptors[c].type = columns[c].type;
+    descriptors[c].offset = offset;
+    offset = align64(offset + rows * columns[c].elementSize);
+  }
+
+  FILE* f = std::fopen(path.c_str(), "wb");
+  if (!f) {
+    error = "cannot create " + path;
+    return false;
+  }
+
+  const uint32_t version = 1;
+  bool ok = std::fwrite("STFEAT01", 1, 8, f) == 8
+         && std::fwrite(&version, 4, 1, f) == 1
+         && std::fwrite(&columnCount, 4, 1, f) == 1
+         && std::fwrite(&rows, 8, 1, f) == 1
+         && std::fwrite(descriptors.data(), sizeof(ColumnDescriptor), columnCount, f) == columnCount;
+
+  for (uint32_t c = 0; ok && c < columnCount; c++) {
+    ok = std::fseek(f, (long)descriptors[c].offset, SEEK_SET) == 0
+      && std::fwrite(columns[c].data, columns[c].elementSize, rows, f) == rows;
+  }
+  // Pad the file so the last column's aligned extent is mapped
+  if (ok && std::fseek(f, (long)offset - 1, SEEK_SET) == 0) {
+    ok = std::fputc(0, f) != EOF;
+  }
+
+  if (std::fclose(f) != 0) ok = false;
+  if (!ok) error = "failed writing " + path;
+  return ok;
+}
@@ -0,0 +1,59 @@
+#ifndef FEATURE_EXTRACTOR_H
+#define FEATURE_EXTRACTOR_H
+
+// Rolling-window predictive-maintenance features over stored telemetry.
+// Windows of windowMs start every hopMs (aligned to multiples of hopMs), so
+// each sample falls in windowMs / hopMs overlapping windows; hopMs equal to
+// windowMs gives tumbling windows. Each output row covers one vehicle over
+// one window that has at least one sample.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "TelemetryLog.h"
+
+// Same limits as checkAndGenerateDTCs() on the device
+#define FEATURE_COOLANT_HIGH_C   40.0f
+#define FEATURE_VOLTAGE_LOW_V    11.8f
+#define FEATURE_MAX_HOLD_MS      60000   // A sample is held at most this long when timing thresholds
+
+struct FeatureTable {
+  std::vector<uint32_t> vehicleId;
+  std::vector<int64_t> windowStartMs;
+  std::vector<uint32_t> sampleCount;
+  std::vector<float> coolantMean;
+  std::vector<float> coolantVar;
+  std::vector<float> voltageMean;
+  std::vector<float> voltageVar;
+  std::vector<float> rpmMean;
+  std::vector<float> rpmVar;
+  std::vector<int64_t> coolantHighMs;     // Time above FEATURE_COOLANT_HIGH_C within the window
+  std::vector<int64_t> voltageLowMs;      // Time below FEATURE_VOLTAGE_LOW_V within the window
+  std::vector<uint32_t> voltageDipCount;  // Crossings below FEATURE_VOLTAGE_LOW_V
+  std::vector<uint32_t> dtcOnsetCount;
+  std::vector<uint32_t> dtcClearCount;
+  std::vector<float> dtcClearLatencyMeanMs;  // Onset to clear, for DTCs cleared in the window
+  std::vector<int64_t> dtcClearLatencyMaxMs;
+
+  size_t size() const { return vehicleId.size(); }
+  void resize(size_t n);
+};
+
+// Compute features for every vehicle and window of windowMs starting every hopMs.
+// The log must be ordered with sortByVehicleAndTime(). Vehicles and windows
+// are processed in parallel when built with OpenMP. Any number of DTCs may be
+// open at once on a vehicle.
+void extractFeatures(const TelemetryLog& log, int64_t windowMs, int64_t hopMs, FeatureTable& table);
+
+// Write the table as a columnar file that numpy can memory-map without copying.
+//
+// Layout (little endian):
+//   char magic[8] "STFEAT01", uint32 version, uint32 columnCount, uint64 rowCount
+//   columnCount x { char name[48], uint32 type, uint32 reserved, uint64 offset }
+//   column data, each column starting on a 64-byte boundary
+// Column types: 1 = uint32, 2 = int64, 3 = float32.
+bool writeFeatureFile(const std::string& path, const FeatureTable& table, std::string& error);
+
+#endif
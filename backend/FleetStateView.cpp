@@ -0,0 +1,194 @@
+#include "FleetStateView.h"
+
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+static_assert(sizeof(VehicleTelemetry) % sizeof(uint64_t) == 0, "record must be whole words");
+static_assert(sizeof(VehicleTelemetry) <= 48, "record and its prior must fit two cache lines");
+
+bool VehicleTelemetry::hasDTC(uint16_t code) const {
+  for (uint8_t i = 0; i < dtcCount && i < FLEET_MAX_DTCS; i++) {
+    if (dtcs[i] == code) return true;
+  }
+  return false;
+}
+
+FleetStateView::FleetStateView(size_t capacity)
+  : slotCount(capacity), slots(new Slot[capacity]), epoch(1) {
+  for (size_t i = 0; i < capacity; i++) {
+    slots[i].seq.store(0, std::memory_order_relaxed);
+    slots[i].epoch.store(0, std::memory_order_relaxed);
+    for (size_t w = 0; w < WORDS; w++) {
+      slots[i].words[w].store(0, std::memory_order_relaxed);
+      slots[i].prior[w].store(0, std::memory_order_relaxed);
+    }
+  }
+  for (AggregateStripe& s : stripes) {
+    s.reporting = 0;
+    s.withDTC = 0;
+    s.withP0118 = 0;
+    s.withP0562 = 0;
+    s.withP0123 = 0;
+    s.lowVoltage = 0;
+    s.fuelCenti = 0;
+    s.coolantCenti = 0;
+  }
+}
+
+bool FleetStateView::update(uint32_t vehicleId, const VehicleTelemetry& state) {
+  if (vehicleId >= slotCount) return false;
+  Slot& slot = slots[vehicleId];
+
+  // Take the record by moving its sequence from even to odd. Sequentially
+  // consistent with the epoch load below and snapshot()'s increment: a write
+  // that reads the old epoch took its record before the snapshot began, so
+  // the snapshot waits for it rather than passing over it.
+  uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+  for (;;) {
+    if ((seq & 1) == 0 &&
+        slot.seq.compare_exchange_weak(seq, seq + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      break;
+    }
+    std::this_thread::yield();
+    seq = slot.seq.load(std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+
+  uint64_t oldWords[WORDS];
+  uint64_t newWords[WORDS];
+  std::memcpy(newWords, &state, sizeof(newWords));
+  uint64_t now = epoch.load(std::memory_order_seq_cst);
+  bool keepPrior = slot.epoch.load(std::memory_order_relaxed) < now;
+  for (size_t w = 0; w < WORDS; w++) {
+    oldWords[w] = slot.words[w].load(std::memory_order_relaxed);
+    if (keepPrior) slot.prior[w].store(oldWords[w], std::memory_order_relaxed);
+    slot.words[w].store(newWords[w], std::memory_order_relaxed);
+  }
+  slot.epoch.store(now, std::memory_order_relaxed);
+
+  slot.seq.store(seq + 2, std::memory_order_release);
+
+  VehicleTelemetry before;
+  std::memcpy(&before, oldWords, sizeof(before));
+  applyDelta(vehicleId, before, state);
+  return true;
+}
+
+void FleetStateView::readSlot(const Slot& slot, VehicleTelemetry& out) const {
+  uint64_t words[WORDS];
+  for (;;) {
+    uint32_t begin = slot.seq.load(std::memory_order_acquire);
+    if (begin & 1) {
+      std::this_thread::yield();
+      continue;
+    }
+    for (size_t w = 0; w < WORDS; w++) words[w] = slot.words[w].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) == begin) break;
+  }
+  std::memcpy(&out, words, sizeof(out));
+}
+
+bool FleetStateView::read(uint32_t vehicleId, VehicleTelemetry& out) const {
+  if (vehicleId >= slotCount) return false;
+  readSlot(slots[vehicleId], out);
+  return true;
+}
+
+static int64_t centi(float value) {
+  return (int64_t)std::llround((double)value * 100.0);
+}
+
+void FleetStateView::snapshot(std::vector<VehicleTelemetry>& out, FleetAggregates* totals) const {
+  std::lock_guard<std::mutex> lock(snapshotLock);
+  // Writes from here on are tagged with a later epoch and leave this one's
+  // record in prior. Only one epoch can be newer than ours: ours is pinned
+  // until we finish.
+  const uint64_t mine = epoch.fetch_add(1, std::memory_order_seq_cst);
+
+  out.resize(slotCount);
+  uint64_t words[WORDS];
+  for (size_t i = 0; i < slotCount; i++) {
+    const Slot& slot = slots[i];
+    for (;;) {
+      uint32_t begin = slot.seq.load(std::memory_order_seq_cst);
+      if (begin & 1) {
+        std::this_thread::yield();
+        continue;
+      }
+      const std::atomic<uint64_t>* src = slot.epoch.load(std::memory_order_relaxed) <= mine ? slot.words : slot.prior;
+      for (size_t w = 0; w < WORDS; w++) words[w] = src[w].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.seq.load(std::memory_order_relaxed) == begin) break;
+    }
+    std::memcpy(&out[i], words, sizeof(words));
+  }
+  if (!totals) return;
+
+  FleetAggregates a = FleetAggregates();
+  int64_t fuel = 0, coolant = 0;
+  for (const VehicleTelemetry& v : out) {
+    if (v.timestampMs == 0) continue;
+    a.reportingVehicles++;
+    a.vehiclesWithDTC += v.dtcCount > 0;
+    a.vehiclesWithP0118 += v.hasDTC(DTC_P0118);
+    a.vehiclesWithP0562 += v.hasDTC(DTC_P0562);
+    a.vehiclesWithP0123 += v.hasDTC(DTC_P0123);
+    a.vehiclesLowVoltage += v.batteryVoltage < FLEET_VOLTAGE_LOW_V;
+    fuel += centi(v.fuelLevel);
+    coolant += centi(v.coolantTemp);
+  }
+  if (a.reportingVehicles > 0) {
+    a.averageFuel = fuel / 100.0 / a.reportingVehicles;
+    a.averageCoolant = coolant / 100.0 / a.reportingVehicles;
+  }
+  *totals = a;
+}
+
+void FleetStateView::applyDelta(uint32_t vehicleId, const VehicleTelemetry& before,
+                                const VehicleTelemetry& after) {
+  AggregateStripe& s = stripes[vehicleId % FLEET_AGGREGATE_STRIPES];
+  const bool wasReporting = before.timestampMs != 0;
+  const bool isReporting = after.timestampMs != 0;
+
+  auto flag = [](bool reporting, bool value) -> int64_t { return reporting && value ? 1 : 0; };
+  auto add = [](std::atomic<int64_t>& counter, int64_t delta) {
+    if (delta != 0) counter.fetch_add(delta, std::memory_order_relaxed);
+  };
+
+  add(s.reporting, (int64_t)isReporting - (int64_t)wasReporting);
+  add(s.withDTC, flag(isReporting, after.dtcCount > 0) - flag(wasReporting, before.dtcCount > 0));
+  add(s.withP0118, flag(isReporting, after.hasDTC(DTC_P0118)) - flag(wasReporting, before.hasDTC(DTC_P0118)));
+  add(s.withP0562, flag(isReporting, after.hasDTC(DTC_P0562)) - flag(wasReporting, before.hasDTC(DTC_P0562)));
+  add(s.withP0123, flag(isReporting, after.hasDTC(DTC_P0123)) - flag(wasReporting, before.hasDTC(DTC_P0123)));
+  add(s.lowVoltage, flag(isReporting, after.batteryVoltage < FLEET_VOLTAGE_LOW_V)
+                  - flag(wasReporting, before.batteryVoltage < FLEET_VOLTAGE_LOW_V));
+  add(s.fuelCenti, (isReporting ? centi(after.fuelLevel) : 0) - (wasReporting ? centi(before.fuelLevel) : 0));
+  add(s.coolantCenti, (isReporting ? centi(after.coolantTemp) : 0) - (wasReporting ? centi(before.coolantTemp) : 0));
+}
+
+FleetAggregates FleetStateView::aggregates() const {
+  int64_t reporting = 0, withDTC = 0, p0118 = 0, p0562 = 0, p0123 = 0, low = 0, fuel = 0, coolant = 0;
+  for (const AggregateStripe& s : stripes) {
+    reporting += s.reporting.load(std::memory_order_relaxed);
+    withDTC += s.withDTC.load(std::memory_order_relaxed);
+    p0118 += s.withP0118.load(std::memory_order_relaxed);
+    p0562 += s.withP0562.load(std::memory_order_relaxed);
+    p0123 += s.withP0123.load(std::memory_order_relaxed);
+    low += s.lowVoltage.load(std::memory_order_relaxed);
+    fuel += s.fuelCenti.load(std::memory_order_relaxed);
+    coolant += s.coolantCenti.load(std::memory_order_relaxed);
+  }
+
+  FleetAggregates a;
+  a.reportingVehicles = reporting;
+  a.vehiclesWithDTC = withDTC;
+  a.vehiclesWithP0118 = p0118;
+  a.vehiclesWithP0562 = p0562;
+  a.vehiclesWithP0123 = p0123;
+  a.vehiclesLowVoltage = low;
+  a.averageFuel = reporting > 0 ? fuel / 100.0 / reporting : 0.0;
+  a.averageCoolant = reporting > 0 ? coolant / 100.0 / reporting : 0.0;
+  return a;
+}
@@ -0,0 +1,116 @@
+#ifndef FLEET_STATE_VIEW_H
+#define FLEET_STATE_VIEW_H
+
+// Latest-state view of the fleet for dashboards.
+// One cache-line record per vehicle, overwritten in place by ingest threads
+// and read through a per-record seqlock: readers never block writers and
+// retry only if they raced with an update to that vehicle. Fleet-wide
+// aggregates are kept incrementally from the old/new record difference, in
+// striped counters so concurrent writers do not share a cache line.
+//
+// Snapshots are point-in-time. Each snapshot() advances a fleet-wide epoch
+// and every write is tagged with the epoch current when it took its record.
+// The first write to a record in a new epoch keeps the old record as its
+// prior, so a snapshot of epoch E takes the record if it was written in E or
+// earlier and the prior if it was written since. A snapshot therefore holds
+// exactly the updates that began before it, and the totals it returns are
+// computed from those same records. Snapshots run one at a time.
+//
+// aggregates() are the cheap running totals, for polling between
+// snapshots. While writers run they can trail or lead any snapshot by the
+// updates in flight. Once writes stop they match snapshot() exactly.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "DtcCodes.h"
+
+#define FLEET_MAX_DTCS          4
+#define FLEET_AGGREGATE_STRIPES 16
+#define FLEET_VOLTAGE_LOW_V     11.8f   // Same limit as checkAndGenerateDTCs()
+
+// Latest telemetry for one vehicle. timestampMs == 0 means never reported.
+struct VehicleTelemetry {
+  int64_t timestampMs;
+  int32_t latE7;
+  int32_t lonE7;
+  float coolantTemp;
+  float batteryVoltage;
+  float fuelLevel;
+  uint16_t rpm;
+  uint16_t speedKmh;
+  uint16_t dtcs[FLEET_MAX_DTCS];   // Packed codes, see encodeDTC()
+  uint8_t dtcCount;
+  uint8_t reserved[7];
+
+  bool hasDTC(uint16_t code) const;
+};
+
+struct FleetAggregates {
+  int64_t reportingVehicles;
+  int64_t vehiclesWithDTC;
+  int64_t vehiclesWithP0118;
+  int64_t vehiclesWithP0562;
+  int64_t vehiclesWithP0123;
+  int64_t vehiclesLowVoltage;
+  double averageFuel;
+  double averageCoolant;
+};
+
+class FleetStateView {
+public:
+  // Vehicle ids are dense in [0, capacity)
+  explicit FleetStateView(size_t capacity);
+
+  size_t capacity() const { return slotCount; }
+
+  // Replace a vehicle's record. Safe from any number of threads.
+  bool update(uint32_t vehicleId, const VehicleTelemetry& state);
+
+  // Consistent copy of one record. Never blocks; retries if it races a writer.
+  bool read(uint32_t vehicleId, VehicleTelemetry& out) const;
+
+  // Copy every record into out (resized to capacity) as of one moment, and
+  // if totals is given, the aggregates over exactly those records
+  void snapshot(std::vector<VehicleTelemetry>& out, FleetAggregates* totals = nullptr) const;
+
+  // Running totals; see the consistency note above
+  FleetAggregates aggregates() const;
+
+private:
+  static const size_t WORDS = sizeof(VehicleTelemetry) / sizeof(uint64_t);
+
+  struct alignas(64) Slot {
+    std::atomic<uint32_t> seq;              // Odd while a write is in progress
+    std::atomic<uint64_t> epoch;            // Epoch the record was written in
+    std::atomic<uint64_t> words[WORDS];
+    std::atomic<uint64_t> prior[WORDS];     // Record as of the epoch before
+  };
+
+  // Sums scaled to integers so they can be updated with fetch_add
+  struct alignas(64) AggregateStripe {
+    std::atomic<int64_t> reporting;
+    std::atomic<int64_t> withDTC;
+    std::atomic<int64_t> withP0118;
+    std::atomic<int64_t> withP0562;
+    std::atomic<int64_t> withP0123;
+    std::atomic<int64_t> lowVoltage;
+    std::atomic<int64_t> fuelCenti;
+    std::atomic<int64_t> coolantCenti;
+  };
+
+  void readSlot(const Slot& slot, VehicleTelemetry& out) const;
+  void applyDelta(uint32_t vehicleId, const VehicleTelemetry& before, const VehicleTelemetry& after);
+
+  size_t slotCount;
+  std::unique_ptr<Slot[]> slots;
+  mutable std::atomic<uint64_t> epoch;   // Advanced by snapshot()
+  mutable std::mutex snapshotLock;
+  AggregateStripe stripes[FLEET_AGGREGATE_STRIPES];
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef POSIX_CLIENT_H
+#define POSIX_CLIENT_H
+
+// Arduino Client-style TCP client over POSIX sockets, so firmware code that
+// talks through a Client (e.g. Uplink) can run on Linux.
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+class PosixClient {
+public:
+  PosixClient() : fd(-1), closed(true) {}
+  ~PosixClient() { stop(); }
+
+  int connect(const char* host, uint16_t port) {
+    stop();
+    char service[8];
+    std::snprintf(service, sizeof(service), "%u", (unsigned)port);
+    addrinfo hints = addrinfo();
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host, service, &hints, &result) != 0) return 0;
+
+    for (addrinfo* ai = result; ai; ai = ai->ai_next) {
+      fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+      if (fd < 0) continue;
+      if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+      close(fd);
+      fd = -1;
+    }
+    freeaddrinfo(result);
+    if (fd < 0) return 0;
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    closed = false;
+    return 1;
+  }
+
+  size_t write(const uint8_t* data, size_t len) {
+    size_t sent = 0;
+    while (fd >= 0 && sent < len) {
+      ssize_t n = send(fd, data + sent, len - sent, MSG_NOSIGNAL);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) {
+        closed = true;
+        break;
+      }
+      sent += (size_t)n;
+    }
+    return sent;
+  }
+
+  int available() {
+    if (fd < 0) return 0;
+    int pending = 0;
+    if (ioctl(fd, FIONREAD, &pending) != 0) return 0;
+    if (pending == 0) {
+      // Distinguish "nothing yet" from an orderly shutdown by the peer
+      char c;
+      ssize_t n = recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+      if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) closed = true;
+    }
+    return pending;
+  }
+
+  int read() {
+    uint8_t c;
+    if (fd < 0 || recv(fd, &c, 1, MSG_DONTWAIT) != 1) return -1;
+    return c;
+  }
+
+  uint8_t connected() {
+    if (fd >= 0 && !closed) available();
+    return fd >= 0 && !closed;
+  }
+
+  void stop() {
+    if (fd >= 0) close(fd);
+    fd = -1;
+    closed = true;
+  }
+
+private:
+  int fd;
+  bool closed;
+};
+
+#endif
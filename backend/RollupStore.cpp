@@ -0,0 +1,366 @@
+#include "RollupStore.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <unordered_set>
+
+const int64_t ROLLUP_TIER_MS[ROLLUP_TIERS] = {60000LL, 3600000LL, 86400000LL};
+
+static const float FIELD_THRESHOLD[ROLLUP_FIELDS] = {ROLLUP_COOLANT_HIGH_C, ROLLUP_VOLTAGE_LOW_V, ROLLUP_RPM_HIGH};
+static const bool FIELD_ALARM_BELOW[ROLLUP_FIELDS] = {false, true, false};
+static const int64_t NO_LIMIT = std::numeric_limits<int64_t>::min();
+
+static bool beyond(int field, float v) {
+  return FIELD_ALARM_BELOW[field] ? v < FIELD_THRESHOLD[field] : v > FIELD_THRESHOLD[field];
+}
+
+static int64_t floorDiv(int64_t a, int64_t b) {
+  int64_t q = a / b;
+  return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+static int64_t floorTo(int64_t t, int64_t width) {
+  return floorDiv(t, width) * width;
+}
+
+static int64_t ceilTo(int64_t t, int64_t width) {
+  int64_t f = floorTo(t, width);
+  return f == t ? t : f + width;
+}
+
+RollupRetention defaultRollupRetention() {
+  RollupRetention r;
+  r.rawMs = 7 * 86400000LL;
+  r.tierMs[ROLLUP_MINUTE] = 30 * 86400000LL;
+  r.tierMs[ROLLUP_HOUR] = 400 * 86400000LL;
+  r.tierMs[ROLLUP_DAY] = 0;
+  return r;
+}
+
+RollupStats::RollupStats()
+  : min(std::numeric_limits<float>::infinity()), max(-std::numeric_limits<float>::infinity()),
+    sum(0.0), count(0), beyondMs(0), coveredMs(0) {}
+
+struct RawSample {
+  int64_t timestampMs;
+  float values[ROLLUP_FIELDS];
+};
+
+// One tier bucket, all fields. Buckets that only received held time have count 0.
+struct Bucket {
+  int64_t startMs;
+  int64_t coveredMs;
+  uint32_t count;
+  float min[ROLLUP_FIELDS];
+  float max[ROLLUP_FIELDS];
+  double sum[ROLLUP_FIELDS];
+  int64_t beyondMs[ROLLUP_FIELDS];
+
+  explicit Bucket(int64_t start) : startMs(start), coveredMs(0), count(0) {
+    for (int f = 0; f < ROLLUP_FIELDS; f++) {
+      min[f] = std::numeric_limits<float>::infinity();
+      max[f] = -std::numeric_limits<float>::infinity();
+      sum[f] = 0.0;
+      beyondMs[f] = 0;
+    }
+  }
+};
+
+struct RollupStore::Series {
+  std::deque<RawSample> raw;
+  std::deque<Bucket> tiers[ROLLUP_TIERS];
+  int64_t rawValidFromMs;                 // Answers from raw samples are exact from here on
+  int64_t tierValidFromMs[ROLLUP_TIERS];  // Likewise per tier, once buckets have expired
+  bool hasLast;
+  RawSample last;
+
+  Series() : rawValidFromMs(NO_LIMIT), hasLast(false) {
+    for (int t = 0; t < ROLLUP_TIERS; t++) tierValidFromMs[t] = NO_LIMIT;
+  }
+
+  // Samples and held intervals only move forward, so the bucket is new or the newest
+  Bucket& bucketAt(int tier, int64_t t) {
+    std::deque<Bucket>& d = tiers[tier];
+    int64_t start = floorTo(t, ROLLUP_TIER_MS[tier]);
+    if (d.empty() || d.back().startMs < start) d.push_back(Bucket(start));
+    return d.back();
+  }
+
+  bool add(int64_t t, const float* values, const RollupRetention& retention) {
+    if (hasLast && t <= last.timestampMs) return false;
+
+    // The previous sample holds until this one, split at minute boundaries
+    if (hasLast) {
+      int64_t end = std::min(t, last.timestampMs + ROLLUP_MAX_HOLD_MS);
+      int64_t a = last.timestampMs;
+      while (a < end) {
+        int64_t b = std::min(end, floorTo(a, ROLLUP_TIER_MS[ROLLUP_MINUTE]) + ROLLUP_TIER_MS[ROLLUP_MINUTE]);
+        for (int tier = 0; tier < ROLLUP_TIERS; tier++) {
+          Bucket& k = bucketAt(tier, a);
+          k.coveredMs += b - a;
+          for (int f = 0; f < ROLLUP_FIELDS; f++) {
+            if (beyond(f, last.values[f])) k.beyondMs[f] += b - a;
+          }
+        }
+        a = b;
+      }
+    }
+
+    for (int tier = 0; tier < ROLLUP_TIERS; tier++) {
+      Bucket& k = bucketAt(tier, t);
+      k.count++;
+      for (int f = 0; f < ROLLUP_FIELDS; f++) {
+        k.min[f] = std::min(k.min[f], values[f]);
+        k.max[f] = std::max(k.max[f], values[f]);
+        k.sum[f] += values[f];
+      }
+    }
+
+    last.timestampMs = t;
+    std::copy(values, values + ROLLUP_FIELDS, last.values);
+    hasLast = true;
+    raw.push_back(last);
+    expire(t, retention);
+    return true;
+  }
+
+  // Drop raw samples and buckets that have aged out as of nowMs: the newest
+  // sample on ingest, the store's clock in RollupStore::expire()
+  void expire(int64_t nowMs, const RollupRetention& retention) {
+    if (retention.rawMs > 0) {
+      int64_t cutoff = nowMs - retention.rawMs;
+      bool dropped = false;
+      while (!raw.empty() && raw.front().timestampMs < cutoff) {
+        raw.pop_front();
+        dropped = true;
+      }
+      // The dropped sample's hold ended at the new first sample, or, with
+      // none left, runs out at most ROLLUP_MAX_HOLD_MS after the last one
+      if (dropped) {
+        rawValidFromMs = raw.empty() ? last.timestampMs + ROLLUP_MAX_HOLD_MS : raw.front().timestampMs;
+      }
+    }
+    for (int tier = 0; tier < ROLLUP_TIERS; tier++) {
+      if (retention.tierMs[tier] <= 0) continue;
+      int64_t cutoff = nowMs - retention.tierMs[tier];
+      std::deque<Bucket>& d = tiers[tier];
+      while (!d.empty() && d.front().startMs + ROLLUP_TIER_MS[tier] <= cutoff) {
+        tierValidFromMs[tier] = d.front().startMs + ROLLUP_TIER_MS[tier];
+        d.pop_front();
+      }
+    }
+  }
+};
+
+static void mergeBuckets(const std::deque<Bucket>& d, int field, int64_t fromMs, int64_t toMs,
+                         RollupStats& out, uint32_t& read) {
+  auto it = std::lower_bound(d.begin(), d.end(), fromMs,
+                             [](const Bucket& b, int64_t t) { return b.startMs < t; });
+  for (; it != d.end() && it->startMs < toMs; ++it) {
+    out.min = std::min(out.min, it->min[field]);
+    out.max = std::max(out.max, it->max[field]);
+    out.sum += it->sum[field];
+    out.count += it->count;
+    out.beyondMs += it->beyondMs[field];
+    out.coveredMs += it->coveredMs;
+    read++;
+  }
+}
+
+// Raw samples in [fromMs, toMs), plus the held time of every sample that reaches into it
+static void mergeRaw(const std::deque<RawSample>& raw, int field, int64_t fromMs, int64_t toMs,
+                     RollupStats& out, uint64_t& read) {
+  auto it = std::lower_bound(raw.begin(), raw.end(), fromMs,
+                             [](const RawSample& s, int64_t t) { return s.timestampMs < t; });
+  if (it != raw.begin()) --it;   // Its hold may reach into the range
+  for (; it != raw.end() && it->timestampMs < toMs; ++it) {
+    const RawSample& s = *it;
+    if (s.timestampMs >= fromMs) {
+      float v = s.values[field];
+      out.min = std::min(out.min, v);
+      out.max = std::max(out.max, v);
+      out.sum += v;
+      out.count++;
+      read++;
+    }
+    auto next = it + 1;
+    if (next == raw.end()) break;  // The newest sample's hold is still open
+    int64_t a = std::max(s.timestampMs, fromMs);
+    int64_t b = std::min(std::min(next->timestampMs, s.timestampMs + ROLLUP_MAX_HOLD_MS), toMs);
+    if (b > a) {
+      out.coveredMs += b - a;
+      if (beyond(field, s.values[field])) out.beyondMs += b - a;
+    }
+  }
+}
+
+// Answer [fromMs, toMs) from the coarsest tier at or below maxTier whose buckets fit inside
+// it, then the edges from finer tiers, and finally raw samples
+static bool planRange(const std::deque<RawSample>& raw, int64_t rawValidFromMs,
+                      const std::deque<Bucket>* tiers, const int64_t* tierValidFromMs,
+                      int field, int64_t fromMs, int64_t toMs, int maxTier,
+                      RollupStats& out, RollupPlan& plan, std::string& error) {
+  if (fromMs >= toMs) return true;
+
+  for (int tier = maxTier; tier >= 0; tier--) {
+    int64_t width = ROLLUP_TIER_MS[tier];
+    int64_t a = ceilTo(std::max(fromMs, tierValidFromMs[tier]), width);
+    int64_t b = floorTo(toMs, width);
+    if (a >= b) continue;
+    mergeBuckets(tiers[tier], field, a, b, out, plan.buckets[tier]);
+    return planRange(raw, rawValidFromMs, tiers, tierValidFromMs, field, fromMs, a, tier - 1, out, plan, error)
+        && planRange(raw, rawValidFromMs, tiers, tierValidFromMs, field, b, toMs, tier - 1, out, plan, error);
+  }
+
+  if (fromMs < rawValidFromMs) {
+    error = "range edge is older than the retained raw samples; align it to a coarser tier";
+    return false;
+  }
+  mergeRaw(raw, field, fromMs, toMs, out, plan.rawSamples);
+  plan.rawSpans++;
+  return true;
+}
+
+RollupStore::RollupStore(const RollupRetention& retention) : retention(retention), rejectedCount(0) {}
+
+RollupStore::~RollupStore() {}
+
+RollupStore::Series* RollupStore::find(uint32_t vehicleId) const {
+  auto it = index.find(vehicleId);
+  return it == index.end() ? NULL : series[it->second].get();
+}
+
+RollupStore::Series& RollupStore::findOrCreate(uint32_t vehicleId) {
+  auto it = index.find(vehicleId);
+  if (it != index.end()) return *series[it->second];
+  index[vehicleId] = series.size();
+  series.push_back(std::unique_ptr<Series>(new Series()));
+  return *series.back();
+}
+
+bool RollupStore::add(uint32_t vehicleId, int64_t timestampMs, const float values[ROLLUP_FIELDS]) {
+  if (findOrCreate(vehicleId).add(timestampMs, values, retention)) return true;
+  rejectedCount++;
+  return false;
+}
+
+size_t RollupStore::ingest(const TelemetryLog& log) {
+  const size_t n = log.size();
+
+  // One run per vehicle; a vehicle seen twice means the log is not ordered
+  std::vector<size_t> runStart;
+  std::vector<Series*> runSeries;
+  std::unordered_set<uint32_t> seen;
+  bool ordered = true;
+  for (size_t i = 0; i < n; i++) {
+    if (i > 0 && log.vehicleId[i] == log.vehicleId[i - 1]) continue;
+    if (!seen.insert(log.vehicleId[i]).second) ordered = false;
+    runStart.push_back(i);
+    runSeries.push_back(&findOrCreate(log.vehicleId[i]));
+  }
+  runStart.push_back(n);
+
+  const long long runCount = (long long)runSeries.size();
+  const RollupRetention& r = retention;
+  size_t accepted = 0;
+  #pragma omp parallel for schedule(dynamic, 1) reduction(+:accepted) if(ordered)
+  for (long long k = 0; k < runCount; k++) {
+    Series& s = *runSeries[k];
+    for (size_t i = runStart[k]; i < runStart[k + 1]; i++) {
+      float values[ROLLUP_FIELDS];
+      values[ROLLUP_COOLANT] = log.coolantTemp[i];
+      values[ROLLUP_VOLTAGE] = log.batteryVoltage[i];
+      values[ROLLUP_RPM] = log.rpm[i];
+      if (s.add(log.timestampMs[i], values, r)) accepted++;
+    }
+  }
+  rejectedCount += n - accepted;
+  return accepted;
+}
+
+void RollupStore::expire(int64_t nowMs) {
+  const long long count = (long long)series.size();
+  const RollupRetention& r = retention;
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (long long k = 0; k < count; k++) {
+    Series& s = *series[k];
+    // A vehicle's clock never runs behind its own newest sample
+    s.expire(s.hasLast && s.last.timestampMs > nowMs ? s.last.timestampMs : nowMs, r);
+  }
+}
+
+bool RollupStore::query(uint32_t vehicleId, int field, int64_t fromMs, int64_t toMs,
+                        RollupStats& out, std::string& error, RollupPlan* plan) const {
+  out = RollupStats();
+  RollupPlan local = RollupPlan();
+  RollupPlan& p = plan ? *plan : local;
+  p = RollupPlan();
+  if (field < 0 || field >= ROLLUP_FIELDS || fromMs >= toMs) {
+    error = "invalid field or empty range";
+    return false;
+  }
+  const Series* s = find(vehicleId);
+  if (s == NULL) {
+    error = "unknown vehicle";
+    return false;
+  }
+  return planRange(s->raw, s->rawValidFromMs, s->tiers, s->tierValidFromMs,
+                   field, fromMs, toMs, ROLLUP_TIERS - 1, out, p, error);
+}
+
+bool RollupStore::queryGrouped(uint32_t vehicleId, int field, int64_t fromMs, int64_t toMs, int64_t groupMs,
+                               std::vector<RollupStats>& out, std::string& error) const {
+  out.clear();
+  if (groupMs <= 0) {
+    error = "group width must be positive";
+    return false;
+  }
+  for (int64_t g = fromMs; g < toMs; g += groupMs) {
+    RollupStats stats;
+    if (!query(vehicleId, field, g, std::min(g + groupMs, toMs), stats, error)) return false;
+    out.push_back(stats);
+  }
+  return true;
+}
+
+bool RollupStore::scanRaw(uint32_t vehicleId, int field, int64_t fromMs, int64_t toMs,
+                          RollupStats& out, std::string& error) const {
+  out = RollupStats();
+  if (field < 0 || field >= ROLLUP_FIELDS || fromMs >= toMs) {
+    error = "invalid field or empty range";
+    return false;
+  }
+  const Series* s = find(vehicleId);
+  if (s == NULL) {
+    error = "unknown vehicle";
+    return false;
+  }
+  if (fromMs < s->rawValidFromMs) {
+    error = "range is older than the retained raw samples";
+    return false;
+  }
+  uint64_t read = 0;
+  mergeRaw(s->raw, field, fromMs, toMs, out, read);
+  return true;
+}
+
+std::vector<uint32_t> RollupStore::vehicles() const {
+  std::vector<uint32_t> ids;
+  ids.reserve(index.size());
+  for (const auto& entry : index) ids.push_back(entry.first);
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+size_t RollupStore::rawSampleCount() const {
+  size_t total = 0;
+  for (const auto& s : series) total += s->raw.size();
+  return total;
+}
+
+size_t RollupStore::bucketCount(int tier) const {
+  size_t total = 0;
+  for (const auto& s : series) total += s->tiers[tier].size();
+  return total;
+}
@@ -0,0 +1,125 @@
+#ifndef ROLLUP_STORE_H
+#define ROLLUP_STORE_H
+
+// Multi-resolution telemetry history for long-range fleet queries.
+// Every sample updates 1-minute, 1-hour and 1-day rollups (min, max, sum,
+// count and time beyond the DTC threshold) per vehicle as it arrives; raw
+// samples are kept only for a retention window, and each tier has its own.
+// A query over [from, to) is planned from the coarsest tier whose buckets
+// fit inside the range, with finer tiers and finally raw samples filling
+// the unaligned edges, so the answer is the same as a raw scan.
+//
+// Time beyond threshold treats each sample as holding until the next one
+// (at most ROLLUP_MAX_HOLD_MS), and splits that interval at minute
+// boundaries, so the time is attributed to the bucket it fell in.
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "TelemetryLog.h"
+
+// Telemetry fields
+#define ROLLUP_COOLANT   0
+#define ROLLUP_VOLTAGE   1
+#define ROLLUP_RPM       2
+#define ROLLUP_FIELDS    3
+
+// Tiers, finest first
+#define ROLLUP_MINUTE    0
+#define ROLLUP_HOUR      1
+#define ROLLUP_DAY       2
+#define ROLLUP_TIERS     3
+
+// Same limits as checkAndGenerateDTCs() and DriverBehavior on the device
+#define ROLLUP_COOLANT_HIGH_C  40.0f   // Time above
+#define ROLLUP_VOLTAGE_LOW_V   11.8f   // Time below
+#define ROLLUP_RPM_HIGH        4000.0f // Time above
+#define ROLLUP_MAX_HOLD_MS     60000   // Same as FEATURE_MAX_HOLD_MS
+
+extern const int64_t ROLLUP_TIER_MS[ROLLUP_TIERS];
+
+// How long each resolution is kept, measured back from the vehicle's newest
+// sample as it arrives, or from the time passed to expire(). 0 = forever.
+struct RollupRetention {
+  int64_t rawMs;
+  int64_t tierMs[ROLLUP_TIERS];
+};
+
+// 7 days raw, 30 days of minutes, 400 days of hours, days forever
+RollupRetention defaultRollupRetention();
+
+// Summary of one field over a time range
+struct RollupStats {
+  float min;
+  float max;
+  double sum;
+  uint64_t count;
+  int64_t beyondMs;     // Time past the field's threshold
+  int64_t coveredMs;    // Time with a held sample
+
+  RollupStats();
+  double mean() const { return count ? sum / count : 0.0; }
+};
+
+// Where an answer came from, for tests and EXPLAIN-style output
+struct RollupPlan {
+  uint32_t buckets[ROLLUP_TIERS];   // Buckets read per tier
+  uint32_t rawSpans;                // Unaligned edges answered from raw samples
+  uint64_t rawSamples;              // Raw samples read for them
+};
+
+class RollupStore {
+public:
+  explicit RollupStore(const RollupRetention& retention = defaultRollupRetention());
+  ~RollupStore();
+
+  // Add one sample (values indexed by ROLLUP_*). Each vehicle's samples must
+  // arrive in time order; older or duplicate timestamps are rejected.
+  // Not safe to call concurrently with anything else.
+  bool add(uint32_t vehicleId, int64_t timestampMs, const float values[ROLLUP_FIELDS]);
+
+  // Add a log ordered with sortByVehicleAndTime(). Vehicles are rolled up in
+  // parallel when built with OpenMP. Returns the number of samples accepted.
+  size_t ingest(const TelemetryLog& log);
+
+  // Apply retention to every vehicle as of nowMs. Ingest only ages out the
+  // vehicle it adds to, so run this periodically for vehicles that have
+  // stopped reporting. Not safe to call concurrently with anything else.
+  void expire(int64_t nowMs);
+
+  // Stats for one field of one vehicle over [fromMs, toMs). Fails if part of
+  // the range can only be answered from data that has been expired.
+  // Queries may run concurrently with each other.
+  bool query(uint32_t vehicleId, int field, int64_t fromMs, int64_t toMs,
+             RollupStats& out, std::string& error, RollupPlan* plan = NULL) const;
+
+  // One result per groupMs window from fromMs, e.g. daily max over a quarter
+  bool queryGrouped(uint32_t vehicleId, int field, int64_t fromMs, int64_t toMs, int64_t groupMs,
+                    std::vector<RollupStats>& out, std::string& error) const;
+
+  // The same answer from raw samples only, for comparison
+  bool scanRaw(uint32_t vehicleId, int field, int64_t fromMs, int64_t toMs,
+               RollupStats& out, std::string& error) const;
+
+  std::vector<uint32_t> vehicles() const;
+  size_t rejected() const { return rejectedCount; }
+  size_t rawSampleCount() const;
+  size_t bucketCount(int tier) const;
+
+private:
+  struct Series;
+
+  Series* find(uint32_t vehicleId) const;
+  Series& findOrCreate(uint32_t vehicleId);
+
+  RollupRetention retention;
+  std::unordered_map<uint32_t, size_t> index;
+  std::vector<std::unique_ptr<Series>> series;
+  size_t rejectedCount;
+};
+
+#endif
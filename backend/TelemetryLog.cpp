@@ -0,0 +1,246 @@
+#include "TelemetryLog.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <numeric>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+void TelemetryLog::reserve(size_t n) {
+  vehicleId.reserve(n);
+  timestampMs.reserve(n);
+  coolantTemp.reserve(n);
+  batteryVoltage.reserve(n);
+  rpm.reserve(n);
+  dtcAction.reserve(n);
+  dtcCode.reserve(n);
+}
+
+void TelemetryLog::append(const TelemetryLog& other) {
+  vehicleId.insert(vehicleId.end(), other.vehicleId.begin(), other.vehicleId.end());
+  timestampMs.insert(timestampMs.end(), other.timestampMs.begin(), other.timestampMs.end());
+  coolantTemp.insert(coolantTemp.end(), other.coolantTemp.begin(), other.coolantTemp.end());
+  batteryVoltage.insert(batteryVoltage.end(), other.batteryVoltage.begin(), other.batteryVoltage.end());
+  rpm.insert(rpm.end(), other.rpm.begin(), other.rpm.end());
+  dtcAction.insert(dtcAction.end(), other.dtcAction.begin(), other.dtcAction.end());
+  dtcCode.insert(dtcCode.end(), other.dtcCode.begin(), other.dtcCode.end());
+}
+
+static int hexDigit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+bool encodeDTC(const char* text, size_t len, uint16_t& code) {
+  if (len != 5) return false;
+
+  static const char systems[] = "PCBU";
+  const char* system = std::find(systems, systems + 4, text[0]);
+  if (system == systems + 4) return false;
+
+  int first = hexDigit(text[1]);
+  if (first < 0 || first > 3) return false;
+
+  uint16_t value = (uint16_t)((system - systems) << 14 | first << 12);
+  for (int i = 2; i < 5; i++) {
+    int d = hexDigit(text[i]);
+    if (d < 0) return false;
+    value |= (uint16_t)(d << (4 * (4 - i)));
+  }
+  code = value;
+  return true;
+}
+
+std::string decodeDTC(uint16_t code) {
+  static const char systems[] = "PCBU";
+  static const char hex[] = "0123456789ABCDEF";
+  std::string text(5, '0');
+  text[0] = systems[code >> 14];
+  text[1] = hex[(code >> 12) & 0x3];
+  text[2] = hex[(code >> 8) & 0xF];
+  text[3] = hex[(code >> 4) & 0xF];
+  text[4] = hex[code & 0xF];
+  return text;
+}
+
+#define MAX_LINE_LENGTH 256
+
+static const char CSV_HEADER[] = "vehicle_id,";
+
+// Parse one line of fewer than MAX_LINE_LENGTH characters into the log.
+// Returns false for malformed lines. The line is copied out and terminated
+// first: strtoul/strtof stop only at a non-digit, and the last line of the
+// mapping need not end in a newline.
+static bool parseFields(const char* begin, size_t length, TelemetryLog& log) {
+  char line[MAX_LINE_LENGTH];
+  std::memcpy(line, begin, length);
+  line[length] = '\0';
+  const char* p = line;
+  const char* end = line + length;
+
+  char* next;
+  unsigned long vehicle = std::strtoul(p, &next, 10);
+  if (next == p || *next != ',') return false;
+  p = next + 1;
+
+  long long ts = std::strtoll(p, &next, 10);
+  if (next == p || *next != ',') return false;
+  p = next + 1;
+
+  float values[3];
+  for (int i = 0; i < 3; i++) {
+    values[i] = std::strtof(p, &next);
+    if (next == p || *next != ',') return false;
+    p = next + 1;
+  }
+
+  int8_t action = DTC_NONE;
+  uint16_t code = 0;
+  const char* fieldEnd = p;
+  while (fieldEnd < end && *fieldEnd != '\r') fieldEnd++;
+  if (fieldEnd > p) {
+    if (*p == '+') action = DTC_ONSET;
+    else if (*p == '-') action = DTC_CLEAR;
+    else return false;
+    if (!encodeDTC(p + 1, (size_t)(fieldEnd - p - 1), code)) return false;
+  }
+
+  log.vehicleId.push_back((uint32_t)vehicle);
+  log.timestampMs.push_back(ts);
+  log.coolantTemp.push_back(values[0]);
+  log.batteryVoltage.push_back(values[1]);
+  log.rpm.push_back(values[2]);
+  log.dtcAction.push_back(action);
+  log.dtcCode.push_back(code);
+  return true;
+}
+
+// Parse one line into the log, counting it in stats if it cannot be used
+static void parseLine(const char* begin, const char* end, TelemetryLog& log, TelemetryLoadStats& stats) {
+  size_t length = (size_t)(end - begin);
+  if (length >= MAX_LINE_LENGTH) {
+    stats.tooLong++;
+    return;
+  }
+  if (!parseFields(begin, length, log)) stats.malformed++;
+}
+
+bool loadTelemetryCsv(const std::string& path, TelemetryLog& log, TelemetryLoadStats& stats, std::string& error) {
+  stats = TelemetryLoadStats();
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    error = "cannot open " + path;
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    error = "cannot stat " + path;
+    return false;
+  }
+  size_t size = (size_t)st.st_size;
+  log = TelemetryLog();
+  if (size == 0) {
+    close(fd);
+    return true;
+  }
+
+  void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    error = "cannot map " + path;
+    return false;
+  }
+  madvise(map, size, MADV_SEQUENTIAL);
+  const char* data = (const char*)map;
+
+  int chunks = 1;
+#ifdef _OPENMP
+  chunks = omp_get_max_threads();
+#endif
+  std::vector<TelemetryLog> parts(chunks);
+  std::vector<TelemetryLoadStats> partStats(chunks, TelemetryLoadStats());
+
+  // The optional header is the file's first line
+  size_t bodyStart = 0;
+  if (size >= sizeof(CSV_HEADER) - 1 && std::memcmp(data, CSV_HEADER, sizeof(CSV_HEADER) - 1) == 0) {
+    while (bodyStart < size && data[bodyStart] != '\n') bodyStart++;
+    bodyStart++;
+  }
+
+  // Each chunk starts at the first full line after its nominal offset
+  #pragma omp parallel for schedule(static, 1)
+  for (int c = 0; c < chunks; c++) {
+    size_t begin = size * c / chunks;
+    size_t end = size * (c + 1) / chunks;
+    if (c > 0) {
+      while (begin < size && data[begin - 1] != '\n') begin++;
+    }
+    while (end < size && data[end - 1] != '\n') end++;
+    if (begin < bodyStart) begin = bodyStart < end ? bodyStart : end;
+
+    TelemetryLog& part = parts[c];
+    part.reserve((end - begin) / 32);
+    const char* p = data + begin;
+    const char* stop = data + end;
+    while (p < stop) {
+      const char* eol = std::find(p, stop, '\n');
+      if (eol > p) parseLine(p, eol, part, partStats[c]);
+      p = eol + 1;
+    }
+  }
+
+  munmap(map, size);
+
+  size_t total = 0;
+  for (const TelemetryLog& part : parts) total += part.size();
+  log.reserve(total);
+  for (const TelemetryLog& part : parts) log.append(part);
+  for (const TelemetryLoadStats& s : partStats) {
+    stats.malformed += s.malformed;
+    stats.tooLong += s.tooLong;
+  }
+  return true;
+}
+
+template <typename T>
+static void permute(std::vector<T>& column, const std::vector<size_t>& order) {
+  std::vector<T> sorted(column.size());
+  for (size_t i = 0; i < order.size(); i++) sorted[i] = column[order[i]];
+  column.swap(sorted);
+}
+
+void sortByVehicleAndTime(TelemetryLog& log) {
+  const size_t n = log.size();
+  auto before = [&](size_t a, size_t b) {
+    if (log.vehicleId[a] != log.vehicleId[b]) return log.vehicleId[a] < log.vehicleId[b];
+    return log.timestampMs[a] < log.timestampMs[b];
+  };
+
+  bool sorted = true;
+  for (size_t i = 1; i < n && sorted; i++) {
+    if (before(i, i - 1)) sorted = false;
+  }
+  if (sorted) return;
+
+  std::vector<size_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), before);
+
+  permute(log.vehicleId, order);
+  permute(log.timestampMs, order);
+  permute(log.coolantTemp, order);
+  permute(log.batteryVoltage, order);
+  permute(log.rpm, order);
+  permute(log.dtcAction, order);
+  permute(log.dtcCode, order);
+}
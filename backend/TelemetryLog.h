@@ -0,0 +1,53 @@
+#ifndef TELEMETRY_LOG_H
+#define TELEMETRY_LOG_H
+
+// Stored fleet telemetry, held column by column.
+//
+// CSV input, one sample per line (header line optional):
+//   vehicle_id,timestamp_ms,coolant_temp,battery_voltage,rpm,dtc
+// where dtc is empty, "+P0118" for a DTC onset or "-P0118" for a clear.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// DTC actions stored per sample
+#define DTC_NONE   0
+#define DTC_ONSET  1
+#define DTC_CLEAR  -1
+
+struct TelemetryLog {
+  std::vector<uint32_t> vehicleId;
+  std::vector<int64_t> timestampMs;
+  std::vector<float> coolantTemp;
+  std::vector<float> batteryVoltage;
+  std::vector<float> rpm;
+  std::vector<int8_t> dtcAction;
+  std::vector<uint16_t> dtcCode;   // SAE J2012 packed form, see encodeDTC()
+
+  size_t size() const { return vehicleId.size(); }
+  void reserve(size_t n);
+  void append(const TelemetryLog& other);
+};
+
+// Pack "P0118" into the 16-bit form used on the OBD-II bus (2 bits system, 14 bits code).
+// Returns false if the text is not a valid DTC.
+bool encodeDTC(const char* text, size_t len, uint16_t& code);
+std::string decodeDTC(uint16_t code);
+
+// Lines loadTelemetryCsv() could not use. A truncated or corrupt log shows
+// up here rather than as quietly wrong features.
+struct TelemetryLoadStats {
+  size_t malformed;   // Bad field count, number, DTC or action (the header line is not counted)
+  size_t tooLong;     // 256 characters or more
+};
+
+// Parse a telemetry CSV. The file is split into chunks parsed in parallel.
+// Unusable lines are skipped and counted in stats.
+bool loadTelemetryCsv(const std::string& path, TelemetryLog& log, TelemetryLoadStats& stats, std::string& error);
+
+// Order samples by vehicle, then time. Skips the sort if already ordered.
+void sortByVehicleAndTime(TelemetryLog& log);
+
+#endif
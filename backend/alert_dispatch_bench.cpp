@@ -0,0 +1,213 @@
+// Alert storm benchmark for AlertDispatcher.
+//
+//   alert_dispatch_bench [vehicles] [minutes] [ingest_threads]
+//
+// Simulates a fleet whose devices repeat each active DTC every 1 s cycle,
+// as checkAndGenerateDTCs() does: overheating episodes that often drag the
+// battery voltage down with them, independent low-voltage and throttle
+// faults, and brief flaps. Events are fed through the dispatcher one
+// simulated second at a time, ticking its event clock each second, and
+// delivered to stub sinks: a dashboard (unlimited), an SMS gateway (20/s,
+// openings only), e-mail (200/s, openings and resolutions) and a webhook
+// (8/s, everything) whose limit keeps updates queued behind held openings.
+// After the replay, ticks continue in event time until held notifications
+// drain. Every opening and resolution is checked to have reached each
+// subscribed sink, and each sink to have seen every incident's
+// notifications in order; exits 1 if not.
+//
+// Build: g++ -O3 -march=native -fopenmp -pthread alert_dispatch_bench.cpp AlertDispatcher.cpp
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "AlertDispatcher.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// Counts deliveries and checks each incident's order; optionally blocks
+// like a network call
+class StubSink : public AlertSink {
+public:
+  StubSink(const char* name, int latencyUs)
+    : label(name), latencyUs(latencyUs), count(0), reportedLimited(0), outOfOrder(0) {
+    for (std::atomic<uint64_t>& k : byKind) k = 0;
+  }
+
+  const char* name() const override { return label; }
+
+  bool deliver(const AlertNotification& n) override {
+    {
+      // Nothing before the opening (if subscribed) or after the resolution
+      std::lock_guard<std::mutex> guard(lock);
+      auto it = lastKind.find(n.incidentId);
+      bool bad = n.kind == ALERT_OPENED ? it != lastKind.end()
+                                        : it != lastKind.end() && it->second == ALERT_RESOLVED;
+      if (bad) outOfOrder.fetch_add(1, std::memory_order_relaxed);
+      lastKind[n.incidentId] = n.kind;
+    }
+    if (latencyUs > 0) std::this_thread::sleep_for(std::chrono::microseconds(latencyUs));
+    count.fetch_add(1, std::memory_order_relaxed);
+    byKind[n.kind].fetch_add(1, std::memory_order_relaxed);
+    reportedLimited.fetch_add(n.rateLimitedBefore, std::memory_order_relaxed);
+    return true;
+  }
+
+  const char* label;
+  int latencyUs;
+  std::atomic<uint64_t> count;
+  std::atomic<uint64_t> byKind[ALERT_RESOLVED + 1];
+  std::atomic<uint64_t> reportedLimited;   // Refusals passed on with later deliveries
+  std::atomic<uint64_t> outOfOrder;
+  std::mutex lock;
+  std::unordered_map<uint64_t, uint8_t> lastKind;
+};
+
+// One fault on one vehicle: active over [start, end) seconds, with optional flap gaps
+struct Fault {
+  uint16_t code;
+  int start;
+  int end;
+};
+
+static void synthesize(uint32_t vehicles, int seconds, std::vector<std::vector<DtcEvent>>& bySecond) {
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<double> uni(0.0, 1.0);
+  bySecond.assign(seconds, std::vector<DtcEvent>());
+
+  for (uint32_t v = 0; v < vehicles; v++) {
+    std::vector<Fault> faults;
+    for (int s = 0; s < seconds; s++) {
+      if (uni(rng) < 1.0 / 3600) {
+        int len = 60 + (int)(540 * uni(rng));
+        faults.push_back(Fault{DTC_P0118, s, s + len});
+        if (uni(rng) < 0.6) {
+          int lag = (int)(120 * uni(rng));
+          faults.push_back(Fault{DTC_P0562, s + lag, s + lag + 30 + (int)(270 * uni(rng))});
+        }
+      }
+      if (uni(rng) < 1.0 / 7200) faults.push_back(Fault{DTC_P0562, s, s + 30 + (int)(270 * uni(rng))});
+      if (uni(rng) < 1.0 / 10000) faults.push_back(Fault{DTC_P0123, s, s + 5 + (int)(55 * uni(rng))});
+    }
+
+    // Merge overlapping episodes of the same code, then emit the device's event stream
+    for (uint16_t code : {DTC_P0118, DTC_P0562, DTC_P0123}) {
+      std::vector<char> active(seconds, 0);
+      for (const Fault& f : faults) {
+        if (f.code != code) continue;
+        for (int s = f.start; s < f.end && s < seconds; s++) active[s] = 1;
+      }
+      // Brief flaps: the reading dips back under the limit for a few cycles
+      for (int s = 0; s < seconds; s++) {
+        if (active[s] && uni(rng) < 0.01) {
+          int gap = 1 + (int)(4 * uni(rng));
+          for (int g = 0; g < gap && s + g < seconds; g++) active[s + g] = 0;
+          s += gap;
+        }
+      }
+      bool was = false;
+      for (int s = 0; s < seconds; s++) {
+        int64_t t = (int64_t)s * 1000;
+        if (active[s]) {
+          bySecond[s].push_back(DtcEvent{v, t, code, DTC_ONSET});   // Repeated every cycle
+        } else if (was) {
+          bySecond[s].push_back(DtcEvent{v, t, code, DTC_CLEAR});
+        }
+        was = active[s] != 0;
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  uint32_t vehicles = argc > 1 ? (uint32_t)std::atol(argv[1]) : 10000;
+  int minutes = argc > 2 ? std::atoi(argv[2]) : 120;
+  unsigned cores = std::thread::hardware_concurrency();
+  int threads = argc > 3 ? std::atoi(argv[3]) : (int)(cores > 0 ? cores : 1);
+  if (vehicles == 0 || minutes <= 0 || threads <= 0) {
+    std::fprintf(stderr, "usage: %s [vehicles] [minutes] [ingest_threads]\n", argv[0]);
+    return 2;
+  }
+
+  const int seconds = minutes * 60;
+  std::vector<std::vector<DtcEvent>> bySecond;
+  synthesize(vehicles, seconds, bySecond);
+  uint64_t total = 0;
+  for (const std::vector<DtcEvent>& s : bySecond) total += s.size();
+  std::printf("events: %llu over %d simulated minutes, %u vehicles\n", (unsigned long long)total, minutes, vehicles);
+
+  StubSink dashboard("dashboard", 0);
+  StubSink sms("sms", 5000);
+  StubSink email("email", 1000);
+  StubSink webhook("webhook", 0);
+  AlertDispatcher dispatcher;
+  dispatcher.addSink(&dashboard, 1e9, 1e9);
+  dispatcher.addSink(&sms, 20, 40, 1 << ALERT_OPENED);
+  dispatcher.addSink(&email, 200, 200, (1 << ALERT_OPENED) | (1 << ALERT_RESOLVED));
+  dispatcher.addSink(&webhook, 8, 20);
+  dispatcher.start();
+
+  Clock::time_point start = Clock::now();
+  for (int s = 0; s < seconds; s++) {
+    const std::vector<DtcEvent>& batch = bySecond[s];
+    const long long n = (long long)batch.size();
+    #pragma omp parallel for num_threads(threads) schedule(static)
+    for (long long i = 0; i < n; i++) dispatcher.submit(batch[i]);
+    dispatcher.tick((int64_t)(s + 1) * 1000);
+  }
+  double ingestS = std::chrono::duration<double>(Clock::now() - start).count();
+
+  // Keep the event clock running until the rate limits have sent what they held
+  int64_t nowMs = (int64_t)seconds * 1000;
+  int drainTicks = 0;
+  for (;;) {
+    dispatcher.flush();
+    bool held = false;
+    for (size_t i = 0; i < 4; i++) held = held || dispatcher.sinkStats(i).pending > 0;
+    if (!held) break;
+    nowMs += 1000;
+    dispatcher.tick(nowMs);
+    drainTicks++;
+  }
+  dispatcher.stop();
+  double drainS = std::chrono::duration<double>(Clock::now() - start).count();
+
+  AlertStats st = dispatcher.stats();
+  std::printf("ingest: %.2f s, %.0f k events/s with %d threads (drained after %.2f s)\n",
+              ingestS, total / ingestS / 1e3, threads, drainS);
+  std::printf("incidents: opened %llu  resolved %llu  still open %zu\n",
+              (unsigned long long)st.opened, (unsigned long long)st.resolved, dispatcher.openIncidents());
+  std::printf("folded: repeats %llu  flaps %llu  correlated %llu  (%.0f events per incident)\n",
+              (unsigned long long)st.repeats, (unsigned long long)st.flaps, (unsigned long long)st.correlated,
+              st.opened ? (double)st.events / st.opened : 0.0);
+  std::printf("held notifications drained %d s of event time after the replay\n", drainTicks);
+  StubSink* stubs[] = {&dashboard, &sms, &email, &webhook};
+  uint8_t kinds[] = {ALERT_ALL_KINDS, 1 << ALERT_OPENED, (1 << ALERT_OPENED) | (1 << ALERT_RESOLVED), ALERT_ALL_KINDS};
+  bool lost = false;
+  uint64_t outOfOrder = 0;
+  for (size_t i = 0; i < 4; i++) {
+    SinkStats ss = dispatcher.sinkStats(i);
+    std::printf("  %-9s delivered %8llu  deferred %7llu (queue full %llu)  updates rate-limited %llu"
+                " coalesced %llu dropped %llu  failed %llu\n",
+                stubs[i]->name(), (unsigned long long)ss.delivered, (unsigned long long)ss.deferred,
+                (unsigned long long)ss.queueFull, (unsigned long long)ss.rateLimited,
+                (unsigned long long)ss.coalesced, (unsigned long long)ss.dropped, (unsigned long long)ss.failed);
+    // Openings and resolutions are never dropped
+    if ((kinds[i] & (1 << ALERT_OPENED)) && stubs[i]->byKind[ALERT_OPENED] != st.opened) lost = true;
+    if ((kinds[i] & (1 << ALERT_RESOLVED)) && stubs[i]->byKind[ALERT_RESOLVED] != st.resolved) lost = true;
+    outOfOrder += stubs[i]->outOfOrder;
+  }
+  if (lost || outOfOrder > 0) {
+    if (lost) std::printf("MISMATCH: an opening or resolution did not reach a subscribed sink\n");
+    if (outOfOrder > 0) std::printf("MISMATCH: %llu notifications arrived out of order\n", (unsigned long long)outOfOrder);
+    return 1;
+  }
+  std::printf("every opening and resolution reached each subscribed sink, in order\n");
+  return 0;
+}
@@ -0,0 +1,153 @@
+// Throughput and cross-check of the batch driver scorer.
+//
+//   driver_score_bench [trips] [mean_trip_minutes] [sample_interval_ms]
+//
+// Synthesises stored trips (stop-and-go traffic with harsh starts and
+// stops, motorway stretches over the speed limit, over-revving and long
+// idles), scores them with scoreTrips(), and times the streaming
+// DriverBehavior engine on the same samples. Every trip's counters and
+// score must match between the two.
+//
+// Build: g++ -O3 -march=native -fopenmp driver_score_bench.cpp DriverScoring.cpp
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "DriverScoring.h"
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct TripColumns {
+  std::vector<uint16_t> speedKmh;
+  std::vector<uint8_t> throttlePct;
+  std::vector<uint16_t> rpm;
+  std::vector<uint64_t> tripOffsets;
+};
+
+static void synthesize(size_t trips, int meanMinutes, uint32_t intervalMs, TripColumns& c) {
+  std::mt19937 rng(26);
+  std::uniform_real_distribution<float> uni(0.0f, 1.0f);
+  const float dtS = intervalMs / 1000.0f;
+
+  c.tripOffsets.push_back(0);
+  for (size_t t = 0; t < trips; t++) {
+    size_t n = (size_t)((0.25f + 1.5f * uni(rng)) * meanMinutes * 60000.0f / intervalMs) + 2;
+    float speed = 0, target = 0;
+    float idleLeft = 0;
+    bool aggressive = false;
+    for (size_t i = 0; i < n; i++) {
+      // Pick a new target speed now and then: a stop, town traffic or the motorway
+      if (uni(rng) < 0.02f * dtS) {
+        float r = uni(rng);
+        target = r < 0.3f ? 0.0f : r < 0.8f ? 20.0f + 40.0f * uni(rng) : 70.0f + 50.0f * uni(rng);
+        if (target == 0 && uni(rng) < 0.2f) idleLeft = 30.0f + 120.0f * uni(rng);   // Waits with the engine running
+        aggressive = uni(rng) < 0.15f;
+      }
+      float maxAccel = (aggressive ? 14.0f : 5.0f) * dtS;
+      float maxBrake = (aggressive ? 16.0f : 6.0f) * dtS;
+      if (speed < target) speed = speed + maxAccel < target ? speed + maxAccel : target;
+      if (speed > target) speed = speed - maxBrake > target ? speed - maxBrake : target;
+      if (speed == 0 && idleLeft > 0) idleLeft -= dtS;
+
+      float gearRpm = speed > 0 ? 900.0f + 45.0f * speed : (idleLeft > 0 || uni(rng) < 0.5f ? 800.0f : 0.0f);
+      if (speed > 0 && uni(rng) < 0.01f) gearRpm += 2500.0f;   // Late upshift
+      float throttle = speed < target ? (aggressive ? 80.0f : 35.0f) : speed > 0 ? 15.0f : 2.0f;
+
+      c.speedKmh.push_back((uint16_t)(speed + 0.5f));
+      c.throttlePct.push_back((uint8_t)throttle);
+      c.rpm.push_back((uint16_t)gearRpm);
+    }
+    c.tripOffsets.push_back(c.speedKmh.size());
+  }
+}
+
+static bool sameStats(const DriverTripStats& a, const DriverTripStats& b) {
+  return a.durationMs == b.durationMs && a.drivingMs == b.drivingMs && a.distanceM == b.distanceM &&
+         a.idleMs == b.idleMs && a.overRevMs == b.overRevMs && a.speedingMs == b.speedingMs &&
+         a.harshAccelCount == b.harshAccelCount && a.harshBrakeCount == b.harshBrakeCount &&
+         a.overRevCount == b.overRevCount && a.idleCount == b.idleCount && a.speedingCount == b.speedingCount;
+}
+
+int main(int argc, char** argv) {
+  size_t trips = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+  int meanMinutes = argc > 2 ? std::atoi(argv[2]) : 30;
+  long intervalMs = argc > 3 ? std::atol(argv[3]) : 1000;
+  if (trips == 0 || meanMinutes <= 0 || intervalMs <= 0) {
+    std::fprintf(stderr, "usage: %s [trips] [mean_trip_minutes] [sample_interval_ms]\n", argv[0]);
+    return 2;
+  }
+
+  TripColumns c;
+  synthesize(trips, meanMinutes, (uint32_t)intervalMs, c);
+  const size_t samples = c.speedKmh.size();
+  std::printf("trips: %zu, %zu samples at %ld ms\n", trips, samples, intervalMs);
+
+  TripBatch batch;
+  batch.speedKmh = c.speedKmh.data();
+  batch.throttlePct = c.throttlePct.data();
+  batch.rpm = c.rpm.data();
+  batch.tripOffsets = c.tripOffsets.data();
+  batch.tripCount = trips;
+  batch.sampleIntervalMs = (uint32_t)intervalMs;
+
+  std::vector<DriverTripStats> stats(trips);
+  std::vector<uint8_t> scores(trips);
+  auto start = std::chrono::steady_clock::now();
+  scoreTrips(batch, stats.data(), scores.data());
+  double batchS = secondsSince(start);
+
+  // The streaming engine, fed one sample at a time as the firmware does
+  std::vector<DriverTripStats> streamed(trips);
+  std::vector<uint8_t> streamedScores(trips);
+  start = std::chrono::steady_clock::now();
+  for (size_t t = 0; t < trips; t++) {
+    DriverBehavior engine;
+    unsigned long nowMs = 0;
+    for (uint64_t i = c.tripOffsets[t]; i < c.tripOffsets[t + 1]; i++) {
+      engine.update(nowMs, c.speedKmh[i], c.throttlePct[i], c.rpm[i]);
+      nowMs += (unsigned long)intervalMs;
+    }
+    streamed[t] = engine.trip();
+    streamedScores[t] = engine.score();
+  }
+  double streamS = secondsSince(start);
+
+  size_t mismatches = 0;
+  uint64_t events = 0, scoreSum = 0;
+  for (size_t t = 0; t < trips; t++) {
+    if (!sameStats(stats[t], streamed[t]) || scores[t] != streamedScores[t]) {
+      if (mismatches < 5) {
+        std::printf("  trip %zu: batch score %u accel %u brake %u, streaming score %u accel %u brake %u\n", t,
+                    scores[t], stats[t].harshAccelCount, stats[t].harshBrakeCount,
+                    streamedScores[t], streamed[t].harshAccelCount, streamed[t].harshBrakeCount);
+      }
+      mismatches++;
+    }
+    events += stats[t].harshAccelCount + stats[t].harshBrakeCount + stats[t].overRevCount +
+              stats[t].idleCount + stats[t].speedingCount;
+    scoreSum += scores[t];
+  }
+
+  std::printf("batch:     %.3f s, %.1f M samples/s\n", batchS, samples / batchS / 1e6);
+  std::printf("streaming: %.3f s, %.1f M samples/s\n", streamS, samples / streamS / 1e6);
+  std::printf("events: %llu (%.1f per trip), mean score %.1f\n", (unsigned long long)events,
+              (double)events / trips, (double)scoreSum / trips);
+  std::printf("cross-check: %zu of %zu trips differ\n", mismatches, trips);
+
+  // A long trip with more episodes than a 16-bit counter holds
+  const size_t longN = 300000;
+  std::vector<uint16_t> sawSpeed(longN);
+  std::vector<uint8_t> sawThrottle(longN, 50);
+  std::vector<uint16_t> sawRpm(longN, 2000);
+  for (size_t i = 0; i < longN; i++) sawSpeed[i] = (i & 1) ? 30 : 0;
+  DriverTripStats saw = scoreTrip(sawSpeed.data(), sawThrottle.data(), sawRpm.data(), longN, 1000);
+  bool wide = saw.harshAccelCount == longN / 2 && saw.harshBrakeCount == longN / 2 - 1;
+  std::printf("counter width: %u harsh accelerations on a %zu-sample trip, %s\n",
+              saw.harshAccelCount, longN, wide ? "ok" : "WRAPPED");
+  return mismatches == 0 && wide ? 0 : 1;
+}
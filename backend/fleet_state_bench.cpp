@@ -0,0 +1,170 @@
+// Update rate and snapshot latency of FleetStateView.
+//
+//   fleet_state_bench [vehicles] [writer_threads] [seconds]
+//
+// Writer t owns the vehicles with id % writers == t and updates them round
+// robin, highest id first (against the snapshot's scan order), stamping the
+// n-th update with timestampMs n + 1. A point-in-time snapshot must then show
+// every writer's updates up to some n and none after, which is checked for
+// each snapshot taken while the writers run, along with the totals returned
+// with it. After the writers stop, checks the incremental aggregates against
+// a full recompute over a snapshot. Exits with status 1 on any failure.
+//
+// Build: g++ -O3 -march=native -pthread fleet_state_bench.cpp FleetStateView.cpp
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "FleetStateView.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double millisSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Aggregates the slow way, rounding fuel and coolant as the view does
+static FleetAggregates recompute(const std::vector<VehicleTelemetry>& fleet) {
+  FleetAggregates a = FleetAggregates();
+  int64_t fuelCenti = 0, coolantCenti = 0;
+  for (const VehicleTelemetry& v : fleet) {
+    if (v.timestampMs == 0) continue;
+    a.reportingVehicles++;
+    a.vehiclesWithDTC += v.dtcCount > 0;
+    a.vehiclesWithP0118 += v.hasDTC(DTC_P0118);
+    a.vehiclesWithP0562 += v.hasDTC(DTC_P0562);
+    a.vehiclesWithP0123 += v.hasDTC(DTC_P0123);
+    a.vehiclesLowVoltage += v.batteryVoltage < FLEET_VOLTAGE_LOW_V;
+    fuelCenti += std::llround((double)v.fuelLevel * 100.0);
+    coolantCenti += std::llround((double)v.coolantTemp * 100.0);
+  }
+  if (a.reportingVehicles > 0) {
+    a.averageFuel = fuelCenti / 100.0 / a.reportingVehicles;
+    a.averageCoolant = coolantCenti / 100.0 / a.reportingVehicles;
+  }
+  return a;
+}
+
+// Writes from writer t land on own[k - 1 - n % k] for n = 0, 1, ... with
+// own = {t, t + writers, ...}. Returns true if the snapshot holds a prefix.
+static bool isCut(const std::vector<VehicleTelemetry>& fleet, unsigned t, unsigned writers) {
+  size_t k = (fleet.size() - t + writers - 1) / writers;
+  if (k == 0) return true;
+  int64_t last = -1;
+  for (size_t id = t; id < fleet.size(); id += writers) last = std::max(last, fleet[id].timestampMs - 1);
+  for (size_t i = 0; i < k; i++) {
+    // Position of vehicle own[i] in the round: p = k - 1 - i
+    int64_t p = (int64_t)(k - 1 - i);
+    int64_t expected = last < p ? 0 : last - (last - p) % (int64_t)k + 1;
+    if (fleet[t + i * writers].timestampMs != expected) return false;
+  }
+  return true;
+}
+
+static bool sameAggregates(const FleetAggregates& a, const FleetAggregates& b) {
+  return a.reportingVehicles == b.reportingVehicles && a.vehiclesWithDTC == b.vehiclesWithDTC &&
+         a.vehiclesWithP0118 == b.vehiclesWithP0118 && a.vehiclesWithP0562 == b.vehiclesWithP0562 &&
+         a.vehiclesWithP0123 == b.vehiclesWithP0123 && a.vehiclesLowVoltage == b.vehiclesLowVoltage &&
+         a.averageFuel == b.averageFuel && a.averageCoolant == b.averageCoolant;
+}
+
+int main(int argc, char** argv) {
+  size_t vehicles = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+  unsigned cores = std::thread::hardware_concurrency();
+  unsigned writers = argc > 2 ? (unsigned)std::atoi(argv[2]) : (cores > 1 ? cores - 1 : 1);
+  double seconds = argc > 3 ? std::atof(argv[3]) : 5.0;
+  if (vehicles == 0 || writers == 0 || seconds <= 0) {
+    std::fprintf(stderr, "usage: %s [vehicles] [writer_threads] [seconds]\n", argv[0]);
+    return 2;
+  }
+
+  FleetStateView view(vehicles);
+  std::atomic<bool> stop(false);
+  std::atomic<uint64_t> updates(0);
+
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < writers; t++) {
+    threads.emplace_back([&, t]() {
+      std::mt19937_64 rng(t + 1);
+      uint64_t done = 0;
+      VehicleTelemetry state = VehicleTelemetry();
+      size_t own = (vehicles - t + writers - 1) / writers;
+      while (own > 0 && !stop.load(std::memory_order_relaxed)) {
+        uint32_t id = (uint32_t)(t + (own - 1 - done % own) * writers);
+        state.timestampMs = 1 + (int64_t)done;
+        state.coolantTemp = 20.0f + (float)(rng() % 300) / 10.0f;
+        state.batteryVoltage = 11.0f + (float)(rng() % 20) / 10.0f;
+        state.fuelLevel = (float)(rng() % 100);
+        state.rpm = (uint16_t)(800 + rng() % 3000);
+        state.speedKmh = (uint16_t)(rng() % 120);
+        state.dtcCount = 0;
+        if (state.coolantTemp > 40.0f) state.dtcs[state.dtcCount++] = DTC_P0118;
+        if (state.batteryVoltage < FLEET_VOLTAGE_LOW_V) state.dtcs[state.dtcCount++] = DTC_P0562;
+        if (rng() % 50 == 0) state.dtcs[state.dtcCount++] = DTC_P0123;
+        view.update(id, state);
+        done++;
+      }
+      updates.fetch_add(done);
+    });
+  }
+
+  // Dashboard reader on this thread
+  std::vector<double> snapshotMs;
+  std::vector<VehicleTelemetry> fleet;
+  FleetAggregates agg = FleetAggregates();
+  size_t torn = 0, totalsWrong = 0;
+  Clock::time_point begin = Clock::now();
+  while (millisSince(begin) < seconds * 1000.0) {
+    Clock::time_point start = Clock::now();
+    view.snapshot(fleet, &agg);
+    snapshotMs.push_back(millisSince(start));
+    for (unsigned t = 0; t < writers; t++) {
+      if (!isCut(fleet, t, writers)) {
+        torn++;
+        break;
+      }
+    }
+    if (!sameAggregates(agg, recompute(fleet))) totalsWrong++;
+  }
+  double elapsed = millisSince(begin) / 1000.0;
+  stop = true;
+  for (std::thread& t : threads) t.join();
+
+  std::sort(snapshotMs.begin(), snapshotMs.end());
+  std::printf("vehicles: %zu  writers: %u\n", vehicles, writers);
+  std::printf("updates: %.2f M/s\n", updates.load() / elapsed / 1e6);
+  std::printf("snapshots: %zu  p50: %.2f ms  max: %.2f ms\n", snapshotMs.size(),
+              snapshotMs[snapshotMs.size() / 2], snapshotMs.back());
+  std::printf("point-in-time: %zu torn snapshots, %zu with wrong totals\n", torn, totalsWrong);
+  std::printf("reporting: %lld  P0118: %lld  P0562: %lld  avg fuel: %.1f\n",
+              (long long)agg.reportingVehicles, (long long)agg.vehiclesWithP0118,
+              (long long)agg.vehiclesWithP0562, agg.averageFuel);
+
+  // Quiesced: the running totals must now equal a recompute from the records
+  view.snapshot(fleet);
+  FleetAggregates incremental = view.aggregates();
+  FleetAggregates full = recompute(fleet);
+  bool match = sameAggregates(incremental, full);
+  std::printf("aggregates vs recompute: %s\n", match ? "match" : "MISMATCH");
+  if (torn || totalsWrong) match = false;
+  if (!match) {
+    std::printf("  incremental: reporting %lld DTC %lld P0118 %lld P0562 %lld P0123 %lld low %lld fuel %.4f coolant %.4f\n",
+                (long long)incremental.reportingVehicles, (long long)incremental.vehiclesWithDTC,
+                (long long)incremental.vehiclesWithP0118, (long long)incremental.vehiclesWithP0562,
+                (long long)incremental.vehiclesWithP0123, (long long)incremental.vehiclesLowVoltage,
+                incremental.averageFuel, incremental.averageCoolant);
+    std::printf("  recompute:   reporting %lld DTC %lld P0118 %lld P0562 %lld P0123 %lld low %lld fuel %.4f coolant %.4f\n",
+                (long long)full.reportingVehicles, (long long)full.vehiclesWithDTC,
+                (long long)full.vehiclesWithP0118, (long long)full.vehiclesWithP0562,
+                (long long)full.vehiclesWithP0123, (long long)full.vehiclesLowVoltage,
+                full.averageFuel, full.averageCoolant);
+  }
+  return match ? 0 : 1;
+}
@@ -0,0 +1,339 @@
+// Local MQTT mock broker for testing the device uplink on Linux.
+//
+//   mock_broker [--port 1883] [--ack-delay-ms N] [--disconnect-every N] [--report-s 5]
+//               [--user NAME --password SECRET]
+//
+// Accepts MQTT 3.1.1 CONNECT (refusing it with return code 4 when --user or
+// --password is given and the client's differ), QoS 0/1 PUBLISH and PINGREQ, decodes SmartTrack
+// batch payloads, and reports messages per second, bytes per sample and how
+// long clients take to come back after a forced disconnect.
+//
+// Build: g++ -O2 mock_broker.cpp -o mock_broker
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "../codes/src/Uplink.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double secondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct PendingAck {
+  Clock::time_point due;
+  uint16_t packetId;
+};
+
+struct Connection {
+  int fd;
+  std::string clientId;
+  std::vector<uint8_t> rx;
+  std::vector<PendingAck> acks;
+  unsigned publishes;
+};
+
+struct Stats {
+  uint64_t publishes = 0;
+  uint64_t duplicates = 0;
+  uint64_t records = 0;
+  uint64_t payloadBytes = 0;
+  uint64_t wireBytes = 0;
+  uint64_t malformed = 0;
+  uint64_t forcedDisconnects = 0;
+  uint64_t refusedConnects = 0;
+  uint64_t recoveries = 0;
+  double recoverySeconds = 0;
+  double worstRecoverySeconds = 0;
+  uint64_t memoryRecords = 0;
+  MemoryRecord lastMemory = MemoryRecord();   // Most recent heap/stack sample from any client
+  uint64_t tripRecords = 0;
+  TripRecord lastTrip = TripRecord();         // Most recent trip summary from any client
+};
+
+// Clients dropped by the broker and when, for recovery time
+static std::map<std::string, Clock::time_point> droppedAt;
+
+// Credentials CONNECT must carry; unchecked when both are empty
+static std::string requiredUser;
+static std::string requiredPassword;
+
+// Read a length-prefixed CONNECT payload string at pos; false if truncated
+static bool readString(const uint8_t* body, uint32_t len, uint32_t& pos, std::string& out) {
+  if (pos + 2 > len) return false;
+  uint16_t n = (uint16_t)(body[pos] << 8 | body[pos + 1]);
+  if (pos + 2 + n > len) return false;
+  out.assign((const char*)body + pos + 2, n);
+  pos += 2 + n;
+  return true;
+}
+
+static bool readRemainingLength(const std::vector<uint8_t>& rx, size_t& pos, uint32_t& len) {
+  len = 0;
+  for (int shift = 0; shift < 28; shift += 7) {
+    if (pos >= rx.size()) return false;
+    uint8_t b = rx[pos++];
+    len |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+static void sendBytes(int fd, const uint8_t* data, size_t len) {
+  while (len > 0) {
+    ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+    if (n <= 0) return;
+    data += n;
+    len -= (size_t)n;
+  }
+}
+
+static void handlePublish(Connection& c, uint8_t flags, const uint8_t* body, uint32_t len,
+                          long ackDelayMs, Stats& stats) {
+  if (len < 2) return;
+  uint16_t topicLen = (uint16_t)(body[0] << 8 | body[1]);
+  size_t pos = 2 + topicLen;
+  uint8_t qos = (flags >> 1) & 3;
+  uint16_t packetId = 0;
+  if (qos > 0) {
+    if (pos + 2 > len) return;
+    packetId = (uint16_t)(body[pos] << 8 | body[pos + 1]);
+    pos += 2;
+  }
+
+  stats.publishes++;
+  if (flags & 0x08) {
+    stats.duplicates++;
+  } else {
+    UplinkBatchReader reader(body + pos, len - pos);
+    UplinkRecord record;
+    uint64_t records = 0;
+    while (reader.next(record)) {
+      records++;
+      if (record.type == UPLINK_REC_MEMORY) {
+        stats.memoryRecords++;
+        stats.lastMemory = record.memory;
+      } else if (record.type == UPLINK_REC_TRIP) {
+        stats.tripRecords++;
+        stats.lastTrip = record.trip;
+      }
+    }
+    if (!reader.valid()) stats.malformed++;
+    stats.records += records;
+    stats.payloadBytes += len - pos;
+  }
+
+  if (qos == 1) {
+    PendingAck ack;
+    ack.due = Clock::now() + std::chrono::milliseconds(ackDelayMs);
+    ack.packetId = packetId;
+    c.acks.push_back(ack);
+  }
+  c.publishes++;
+}
+
+// Parse complete packets from the connection. Returns false to close it.
+static bool handleInput(Connection& c, long ackDelayMs, unsigned disconnectEvery, Stats& stats) {
+  size_t pos = 0;
+  while (pos < c.rx.size()) {
+    size_t start = pos;
+    uint8_t header = c.rx[pos++];
+    uint32_t len;
+    if (!readRemainingLength(c.rx, pos, len) || pos + len > c.rx.size()) {
+      pos = start;
+      break;
+    }
+    const uint8_t* body = c.rx.data() + pos;
+    pos += len;
+    stats.wireBytes += pos - start;
+
+    switch (header >> 4) {
+      case 1: {   // CONNECT
+        std::string user, password;
+        uint32_t at = 10;
+        if (len >= 10 && readString(body, len, at, c.clientId)) {
+          uint8_t flags = body[7];
+          if (flags & 0x80) readString(body, len, at, user);
+          if (flags & 0x40) readString(body, len, at, password);
+        }
+        if ((!requiredUser.empty() || !requiredPassword.empty()) &&
+            (user != requiredUser || password != requiredPassword)) {
+          stats.refusedConnects++;
+          const uint8_t refused[4] = {0x20, 0x02, 0x00, 0x04};   // Bad user name or password
+          sendBytes(c.fd, refused, sizeof(refused));
+          return false;
+        }
+        auto dropped = droppedAt.find(c.clientId);
+        if (dropped != droppedAt.end()) {
+          double s = secondsSince(dropped->second);
+          stats.recoveries++;
+          stats.recoverySeconds += s;
+          if (s > stats.worstRecoverySeconds) stats.worstRecoverySeconds = s;
+          droppedAt.erase(dropped);
+        }
+        const uint8_t connack[4] = {0x20, 0x02, 0x00, 0x00};
+        sendBytes(c.fd, connack, sizeof(connack));
+        break;
+      }
+      case 3:     // PUBLISH
+        handlePublish(c, header & 0x0F, body, len, ackDelayMs, stats);
+        if (disconnectEvery > 0 && c.publishes % disconnectEvery == 0) {
+          stats.forcedDisconnects++;
+          droppedAt[c.clientId] = Clock::now();
+          return false;
+        }
+        break;
+      case 12: {  // PINGREQ
+        const uint8_t pingresp[2] = {0xD0, 0x00};
+        sendBytes(c.fd, pingresp, sizeof(pingresp));
+        break;
+      }
+      case 14:    // DISCONNECT
+        return false;
+      default:
+        break;
+    }
+  }
+  c.rx.erase(c.rx.begin(), c.rx.begin() + pos);
+  return true;
+}
+
+static void flushAcks(Connection& c) {
+  Clock::time_point now = Clock::now();
+  size_t kept = 0;
+  for (const PendingAck& ack : c.acks) {
+    if (ack.due <= now) {
+      const uint8_t puback[4] = {0x40, 0x02, (uint8_t)(ack.packetId >> 8), (uint8_t)(ack.packetId & 0xFF)};
+      sendBytes(c.fd, puback, sizeof(puback));
+    } else {
+      c.acks[kept++] = ack;
+    }
+  }
+  c.acks.resize(kept);
+}
+
+static void report(const Stats& stats, const Stats& last, double interval) {
+  uint64_t published = stats.publishes - last.publishes;
+  uint64_t records = stats.records - last.records;
+  std::printf("msgs/s: %.1f  records/s: %.1f  payload B/sample: %.2f  wire B/sample: %.2f  dup: %llu",
+              published / interval, records / interval,
+              stats.records ? (double)stats.payloadBytes / stats.records : 0.0,
+              stats.records ? (double)stats.wireBytes / stats.records : 0.0,
+              (unsigned long long)stats.duplicates);
+  if (stats.recoveries > 0) {
+    std::printf("  reconnect: avg %.2fs max %.2fs (%llu)", stats.recoverySeconds / stats.recoveries,
+                stats.worstRecoverySeconds, (unsigned long long)stats.recoveries);
+  }
+  if (stats.malformed > 0) std::printf("  malformed: %llu", (unsigned long long)stats.malformed);
+  if (stats.refusedConnects > 0) std::printf("  refused: %llu", (unsigned long long)stats.refusedConnects);
+  if (stats.memoryRecords > last.memoryRecords) {
+    const MemoryRecord& m = stats.lastMemory;
+    std::printf("  mem: free %u largest %u frag %u%% min %u stack", m.freeHeap, m.largestBlock,
+                m.fragmentationPct, m.minFreeHeap);
+    for (uint8_t i = 0; i < m.stackCount; i++) std::printf("%c%u", i ? '/' : ' ', m.stackHighWater[i]);
+  }
+  if (stats.tripRecords > last.tripRecords) {
+    const TripRecord& t = stats.lastTrip;
+    std::printf("  trip: %.1f km %us score %u", t.distanceM / 1000.0, t.durationS, t.score);
+  }
+  std::printf("\n");
+  std::fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+  int port = 1883;
+  long ackDelayMs = 0;
+  unsigned disconnectEvery = 0;
+  double reportSeconds = 5;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string opt = argv[i];
+    if (opt == "--port") port = std::atoi(argv[i + 1]);
+    else if (opt == "--ack-delay-ms") ackDelayMs = std::atol(argv[i + 1]);
+    else if (opt == "--disconnect-every") disconnectEvery = (unsigned)std::atoi(argv[i + 1]);
+    else if (opt == "--report-s") reportSeconds = std::atof(argv[i + 1]);
+    else if (opt == "--user") requiredUser = argv[i + 1];
+    else if (opt == "--password") requiredPassword = argv[i + 1];
+    else {
+      std::fprintf(stderr, "unknown option %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  int listener = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr = sockaddr_in();
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons((uint16_t)port);
+  if (bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, 64) != 0) {
+    std::perror("mock_broker");
+    return 1;
+  }
+  std::printf("mock broker listening on port %d\n", port);
+  std::fflush(stdout);
+
+  std::vector<Connection> connections;
+  Stats stats, last;
+  Clock::time_point lastReport = Clock::now();
+
+  for (;;) {
+    std::vector<pollfd> fds(1 + connections.size());
+    fds[0].fd = listener;
+    fds[0].events = POLLIN;
+    for (size_t i = 0; i < connections.size(); i++) {
+      fds[i + 1].fd = connections[i].fd;
+      fds[i + 1].events = POLLIN;
+    }
+    poll(fds.data(), fds.size(), 10);
+
+    if (fds[0].revents & POLLIN) {
+      int fd = accept(listener, nullptr, nullptr);
+      if (fd >= 0) connections.push_back(Connection{fd, std::string(), {}, {}, 0});
+    }
+
+    for (size_t i = 0; i < connections.size(); i++) {
+      Connection& c = connections[i];
+      bool keep = true;
+      if (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) {
+        uint8_t buf[4096];
+        ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+          keep = false;
+        } else {
+          c.rx.insert(c.rx.end(), buf, buf + n);
+          keep = handleInput(c, ackDelayMs, disconnectEvery, stats);
+        }
+      }
+      if (keep) {
+        flushAcks(c);
+      } else {
+        close(c.fd);
+        c.fd = -1;
+      }
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < connections.size(); i++) {
+      if (connections[i].fd >= 0) connections[kept++] = connections[i];
+    }
+    connections.resize(kept);
+
+    double interval = secondsSince(lastReport);
+    if (interval >= reportSeconds) {
+      report(stats, last, interval);
+      last = stats;
+      lastReport = Clock::now();
+    }
+  }
+}
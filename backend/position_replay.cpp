@@ -0,0 +1,233 @@
+// Replay benchmark for the firmware's GPS/odometry position filter.
+//
+//   position_replay [trips] [trip_minutes] [seed]
+//
+// Synthesises drives (speed changes, turns) with 1 Hz GPS fixes carrying
+// NEO-6M-like noise, broken by two kinds of outage: tunnels entered at
+// speed, where the filter already has a heading, and underground garage
+// exits, where a fresh filter has a fix but no heading yet. Each trip runs
+// through PositionFilter at the field board's 1 s loop, next to the naive
+// alternative of holding the last fix. Reports position error during
+// outages and with GPS, how often the truth lies within errorRadiusM(), and
+// the cost of predict() and updateGps(). A last case drives a vehicle that
+// never gets a fix after the first one for a day and a half along a fixed
+// course, far past the int32 range of the filter's millimetre offsets.
+//
+// Build: g++ -O2 position_replay.cpp -o position_replay
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+
+#include "../codes/src/PositionFilter.h"
+
+#define STEP_MS 1000                 // Field board sample period
+#define START_LAT_E7 129715980       // Bangalore
+#define START_LON_E7 775945660
+
+enum Phase { WITH_GPS, TUNNEL, GARAGE };
+
+struct Errors {
+  std::vector<double> filter;
+  std::vector<double> held;
+  size_t covered = 0;
+};
+
+static double metresBetween(int32_t latA, int32_t lonA, int32_t latB, int32_t lonB) {
+  double north = (latA - latB) * 0.011054;
+  double east = (lonA - lonB) * 0.011132 * std::cos(latA * 1e-7 * M_PI / 180);
+  return std::sqrt(north * north + east * east);
+}
+
+static double percentile(std::vector<double>& v, double p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[std::min(v.size() - 1, (size_t)(p * v.size()))];
+}
+
+static void report(const char* label, Errors& e) {
+  size_t n = e.filter.size();
+  std::printf("%-10s %7zu s  filter p50 %6.1f m  p95 %6.1f m  max %7.1f m  |  held fix p50 %6.1f m  p95 %6.1f m"
+              "  |  within radius %.1f%%\n",
+              label, n, percentile(e.filter, 0.5), percentile(e.filter, 0.95),
+              n ? *std::max_element(e.filter.begin(), e.filter.end()) : 0.0,
+              percentile(e.held, 0.5), percentile(e.held, 0.95), n ? 100.0 * e.covered / n : 0.0);
+}
+
+struct Cost {
+  double ns;
+  double cycles;
+};
+
+template <typename Call>
+static Cost timeCalls(size_t n, Call call) {
+#ifdef HAVE_RDTSC
+  uint64_t c0 = __rdtsc();
+#endif
+  auto t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < n; i++) call(i);
+  Cost c;
+  c.ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / n;
+#ifdef HAVE_RDTSC
+  c.cycles = (double)(__rdtsc() - c0) / n;
+#else
+  c.cycles = 0;
+#endif
+  return c;
+}
+
+static void printCost(const char* label, const Cost& c) {
+  std::printf("%-12s %6.1f ns/call", label, c.ns);
+#ifdef HAVE_RDTSC
+  std::printf(", %.0f TSC cycles", c.cycles);
+#endif
+  std::printf("\n");
+}
+
+// One fix and a course, then no GPS for `hours` at a steady speed. The truth
+// follows the same rhumb line on the globe, stepping latitude and longitude
+// directly so it owes nothing to the filter's local frame.
+static void longOutage(double hours, int speedKmh, double headingDeg) {
+  double lat = START_LAT_E7 * 1e-7, lon = START_LON_E7 * 1e-7;
+  PositionFilter filter;
+  filter.updateGps(START_LAT_E7, START_LON_E7);
+  filter.setHeading((int32_t)std::lround(headingDeg * 100));
+
+  const double d = speedKmh / 3.6 * STEP_MS / 1000;
+  long steps = (long)(hours * 3600 * 1000 / STEP_MS);
+  double maxErr = 0, err = 0;
+  for (long step = 0; step < steps; step++) {
+    filter.predict(STEP_MS, speedKmh);
+    lat += d * std::cos(headingDeg * M_PI / 180) * 1e-7 / 0.011054;
+    lon += d * std::sin(headingDeg * M_PI / 180) * 1e-7 / (0.011132 * std::cos(lat * M_PI / 180));
+    if (lon >= 180) lon -= 360;
+    err = metresBetween(filter.latE7Estimate(), filter.lonE7Estimate(),
+                        (int32_t)std::lround(lat * 1e7), (int32_t)std::lround(lon * 1e7));
+    maxErr = std::max(maxErr, err);
+  }
+  double km = d * steps / 1000;
+  std::printf("no fix     %.0f h at %d km/h, %.0f km: end at %.5f, %.5f, off by %.1f m (%.3f%% of the distance), max %.1f m\n",
+              hours, speedKmh, km, lat, lon, err, 100 * err / (km * 1000), maxErr);
+}
+
+int main(int argc, char** argv) {
+  long trips = argc > 1 ? std::atol(argv[1]) : 500;
+  double tripMinutes = argc > 2 ? std::atof(argv[2]) : 30;
+  unsigned seed = argc > 3 ? (unsigned)std::atoi(argv[3]) : 1;
+  if (trips <= 0 || tripMinutes <= 0) {
+    std::fprintf(stderr, "usage: %s [trips] [trip_minutes] [seed]\n", argv[0]);
+    return 2;
+  }
+
+  std::mt19937 rng(seed);
+  std::normal_distribution<double> noise(0.0, 1.0);
+  std::uniform_real_distribution<double> uni(0.0, 1.0);
+  const double gpsAxisSigmaM = POS_GPS_SIGMA_M / std::sqrt(2.0);
+
+  Errors errors[3];
+  std::vector<int> speeds;                          // Replayed again for timing
+  std::vector<std::pair<int32_t, int32_t> > fixes;
+  size_t rejected = 0;
+
+  for (long trip = 0; trip < trips; trip++) {
+    // Truth in the filter's flat-earth frame around the start, metres
+    double east = 0, north = 0;
+    double heading = uni(rng) * 360;
+    double speed = 0, targetSpeed = 40;
+    int32_t heldLat = 0, heldLon = 0;
+    PositionFilter filter;
+
+    // Leave an underground garage: a few fixes at the entrance while parked,
+    // then 30-90 s of driving with no GPS and no course yet
+    int parkedSteps = 5;
+    int outageLeft = 30 + (int)(uni(rng) * 60);
+    Phase phase = GARAGE;
+
+    int steps = (int)(tripMinutes * 60 * 1000 / STEP_MS);
+    for (int step = 0; step < steps; step++) {
+      bool parked = step < parkedSteps;
+
+      // Advance the truth: speed follows a target that changes now and then,
+      if (!parked) {
+        if (uni(rng) < 0.02) targetSpeed = 20 + uni(rng) * 80;
+        speed += std::max(-8.0, std::min(5.0, targetSpeed - speed));
+        if (speed < 0) speed = 0;
+        // heading drifts (gently in tunnels) and occasionally turns at a junction
+        heading += noise(rng) * (phase == TUNNEL ? 0.3 : 2);
+        if (uni(rng) < 0.01 && phase != TUNNEL) heading += uni(rng) < 0.5 ? 90 : -90;
+        double d = speed / 3.6 * STEP_MS / 1000;
+        east += d * std::sin(heading * M_PI / 180);
+        north += d * std::cos(heading * M_PI / 180);
+      }
+      int32_t truthLat = START_LAT_E7 + (int32_t)std::lround(north / 0.011054);
+      int32_t truthLon = START_LON_E7 +
+        (int32_t)std::lround(east / (0.011132 * std::cos(START_LAT_E7 * 1e-7 * M_PI / 180)));
+
+      // Outage bookkeeping: tunnels start at speed, about every 10 minutes
+      if (!parked && phase != WITH_GPS && --outageLeft <= 0) phase = WITH_GPS;
+      if (phase == WITH_GPS && speed > 30 && uni(rng) < 1.0 / 600) {
+        phase = TUNNEL;
+        outageLeft = 20 + (int)(uni(rng) * 160);
+      }
+      bool gpsUp = phase == WITH_GPS || parked;
+
+      // One loop of the firmware: dead-reckon on OBD speed, then take a fix
+      int obdSpeed = (int)std::lround(speed);
+      filter.predict(STEP_MS, obdSpeed);
+      speeds.push_back(obdSpeed);
+
+      if (gpsUp) {
+        int32_t fixLat = truthLat + (int32_t)std::lround(noise(rng) * gpsAxisSigmaM / 0.011054);
+        int32_t fixLon = truthLon + (int32_t)std::lround(noise(rng) * gpsAxisSigmaM / 0.011132);
+        if (!filter.updateGps(fixLat, fixLon)) rejected++;
+        fixes.push_back(std::make_pair(fixLat, fixLon));
+        // GPS reports a course only when moving
+        if (speed > 5) filter.setHeading((int32_t)std::lround(heading * 100 + noise(rng) * 200));
+        heldLat = fixLat;
+        heldLon = fixLon;
+      }
+
+      Phase bucket = gpsUp ? WITH_GPS : phase;
+      double err = metresBetween(filter.latE7Estimate(), filter.lonE7Estimate(), truthLat, truthLon);
+      errors[bucket].filter.push_back(err);
+      errors[bucket].held.push_back(metresBetween(heldLat, heldLon, truthLat, truthLon));
+      if (err <= filter.errorRadiusM()) errors[bucket].covered++;
+    }
+  }
+
+  std::printf("trips: %ld x %.0f min, %zu fixes (%zu rejected)\n", trips, tripMinutes, fixes.size(), rejected);
+  report("with GPS", errors[WITH_GPS]);
+  report("tunnel", errors[TUNNEL]);
+  report("garage", errors[GARAGE]);
+  longOutage(36, 90, 60);
+
+  // Cost per call, timed over the whole replay rather than per call so the
+  // clock itself stays out of the figure
+  PositionFilter timed;
+  timed.updateGps(START_LAT_E7, START_LON_E7);
+  timed.setHeading(4500);
+  uint32_t sink = 0;
+  Cost predict = timeCalls(speeds.size(), [&](size_t i) {
+    timed.predict(STEP_MS, speeds[i]);
+    sink += (uint32_t)timed.latE7Estimate();
+  });
+  Cost update = timeCalls(fixes.size(), [&](size_t i) {
+    timed.predict(STEP_MS, speeds[i]);
+    sink += timed.updateGps(fixes[i].first, fixes[i].second);
+  });
+  update.ns -= predict.ns;
+  update.cycles -= predict.cycles;
+  printCost("predict()", predict);
+  printCost("updateGps()", update);
+  if (sink == 1) std::printf("\n");  // Keep the timed work observable
+  return 0;
+}
@@ -0,0 +1,140 @@
+// Host simulation of the firmware's duty-cycling state machine.
+//
+//   power_sim [days] [driving_period_ms] [work_ms] [nmea_bytes] [wifi]
+//
+// Replays a commuter day (two 40-minute drives, an idling stop, parked the
+// rest) through PowerPolicy and reports time per power state and the
+// average current against the always-awake firmware. While driving, the
+// firmware stays awake through each 1 Hz NMEA burst from the GPS, so a
+// window lasts at least the burst; nmea_bytes = 0 models a board without
+// GPS. The GPS receiver's own supply current is reported separately.
+// wifi = 1 (the field and Wokwi boards) keeps the uplink associated between
+// windows in auto light sleep; wifi = 2 is the same on a core built without
+// power management, idling in modem sleep; wifi = 0 light-sleeps with the
+// radio off.
+//
+// Build: g++ -O2 power_sim.cpp -o power_sim
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "../codes/src/PowerPolicy.h"
+
+#define CHECKIN_WORK_MS 2500   // Boot, WiFi join and one uplink flush after a deep-sleep wake
+
+// Same timing as GpsModule in codes/src/Peripherals.h
+#define GPS_BAUD 9600
+#define GPS_QUIET_MS 20
+#define GPS_WAKE_LEAD_MS 30
+#define GPS_RECEIVER_UA 45000  // NEO-6M while tracking
+
+struct Trip {
+  uint32_t startMin;
+  uint32_t durationMin;
+  bool moving;               // false: engine idling at a stop
+};
+
+static const Trip day[] = {
+  {8 * 60, 40, true},
+  {12 * 60 + 30, 10, false},
+  {17 * 60 + 30, 40, true},
+};
+
+static bool activeAt(uint64_t ms, bool& moving) {
+  uint32_t minute = (uint32_t)((ms / 60000) % (24 * 60));
+  for (const Trip& t : day) {
+    if (minute >= t.startMin && minute < t.startMin + t.durationMin) {
+      moving = t.moving;
+      return true;
+    }
+  }
+  return false;
+}
+
+int main(int argc, char** argv) {
+  double days = argc > 1 ? std::atof(argv[1]) : 7;
+  uint32_t period = argc > 2 ? (uint32_t)std::atol(argv[2]) : 1000;
+  uint32_t workMs = argc > 3 ? (uint32_t)std::atol(argv[3]) : 150;
+  uint32_t nmeaBytes = argc > 4 ? (uint32_t)std::atol(argv[4]) : 480;   // NEO-6M default sentence set
+  int wifi = argc > 5 ? std::atoi(argv[5]) : 1;
+  if (days <= 0 || period == 0) {
+    std::fprintf(stderr, "usage: %s [days] [driving_period_ms] [work_ms] [nmea_bytes] [wifi]\n", argv[0]);
+    return 2;
+  }
+  const bool hasGps = nmeaBytes > 0;
+  // Awake through the burst (10 bits a byte) plus the wake lead and the silence that ends it
+  uint32_t burstMs = nmeaBytes * 10000 / GPS_BAUD;
+  uint32_t gpsWorkMs = (workMs > burstMs ? workMs : burstMs) + GPS_WAKE_LEAD_MS + GPS_QUIET_MS;
+
+  PowerPolicy policy(period);
+  EnergyCounters counters = EnergyCounters();
+  const uint64_t endMs = (uint64_t)(days * 24 * 3600 * 1000);
+  uint64_t now = 0;
+  bool resumed = false;
+  bool gpsOn = hasGps;
+  uint64_t gpsOnMs = 0;
+  uint64_t windows[3] = {0, 0, 0};
+
+  while (now < endMs) {
+    uint32_t work = resumed ? CHECKIN_WORK_MS : gpsOn ? gpsWorkMs : workMs;
+    counters.awakeMs += work;
+    if (gpsOn) gpsOnMs += work;
+    now += work;
+
+    bool moving = false;
+    bool ignition = activeAt(now, moving);
+    int speed = ignition && moving ? 50 : 0;
+    PowerDecision d = policy.decide((uint32_t)now, speed, ignition, work);
+    windows[d.mode]++;
+
+    // The ignition input wakes the device early from either sleep
+    uint64_t wake = now + d.sleepMs;
+    for (uint64_t t = now; t < wake; t += 1000) {
+      bool m;
+      if (!ignition && activeAt(t, m)) {
+        wake = t;
+        break;
+      }
+    }
+    uint64_t slept = wake - now;
+    if (d.deep) counters.deepSleepMs += slept;
+    else if (wifi == 2) counters.modemSleepMs += slept;
+    else if (wifi) counters.wifiSleepMs += slept;
+    else counters.lightSleepMs += slept;
+    if (slept > 0) counters.wakeups++;
+    gpsOn = hasGps && d.gpsPowered;
+    if (gpsOn) gpsOnMs += slept;
+    now = wake;
+
+    // A deep-sleep wake restarts the firmware: parked check-in unless the ignition woke it
+    resumed = d.deep && !activeAt(now, moving);
+    if (d.deep) {
+      policy.begin((uint32_t)now, resumed);
+      gpsOn = hasGps && !resumed;
+    }
+  }
+
+  uint64_t idle = counters.lightSleepMs + counters.wifiSleepMs + counters.modemSleepMs;
+  uint64_t total = counters.awakeMs + idle + counters.deepSleepMs;
+  std::printf("simulated: %.1f days  driving period: %u ms  work per window: %u ms", days, period, workMs);
+  if (hasGps) std::printf("  NMEA burst: %u ms (%u bytes)", burstMs, nmeaBytes);
+  std::printf("  between windows: %s\n", wifi == 2 ? "modem sleep, WiFi associated"
+              : wifi ? "auto light sleep, WiFi associated" : "light sleep, radio off");
+  std::printf("windows: driving %llu  parked %llu  deep check-ins %llu\n",
+              (unsigned long long)windows[POWER_DRIVING], (unsigned long long)windows[POWER_PARKED],
+              (unsigned long long)windows[POWER_DEEP]);
+  std::printf("awake: %.2f%%  between windows: %.2f%%  deep sleep: %.2f%%  wakeups: %u\n",
+              100.0 * counters.awakeMs / total, 100.0 * idle / total,
+              100.0 * counters.deepSleepMs / total, counters.wakeups);
+  uint32_t average = powerAverageMicroAmps(counters);
+  std::printf("average current: %.3f mA  (always awake: %.1f mA, %.0fx lower)\n",
+              average / 1000.0, POWER_AWAKE_UA / 1000.0, (double)POWER_AWAKE_UA / average);
+  std::printf("energy per day: %.1f mAh\n", average / 1000.0 * 24);
+  if (hasGps) {
+    double gpsAverage = (double)gpsOnMs / total * GPS_RECEIVER_UA;
+    std::printf("GPS receiver: on %.2f%%  average %.3f mA (always on: %.1f mA)  module + GPS per day: %.1f mAh\n",
+                100.0 * gpsOnMs / total, gpsAverage / 1000.0, GPS_RECEIVER_UA / 1000.0,
+                (average + gpsAverage) / 1000.0 * 24);
+  }
+  return 0;
+}
@@ -0,0 +1,202 @@
+"""Load SmartTrack feature files and benchmark the C++ extractor against pandas.
+
+Feature files written by backend/feature_extract are memory-mapped, so
+load_features() returns numpy arrays that view the file without copying.
+
+    python smarttrack_features.py bench --extractor ./feature_extract \
+        --vehicles 200 --hours 24 --window 3600 --hop 900
+"""
+
+import argparse
+import mmap
+import os
+import random
+import struct
+import subprocess
+import tempfile
+import time
+
+import numpy as np
+
+COLUMN_DTYPES = {1: np.uint32, 2: np.int64, 3: np.float32}
+HEADER = struct.Struct("<8sIIQ")
+DESCRIPTOR = struct.Struct("<48sIIQ")
+
+COOLANT_HIGH_C = 40.0
+VOLTAGE_LOW_V = 11.8
+MAX_HOLD_MS = 60000
+
+
+def load_features(path):
+    """Return {column name: numpy array} backed by a read-only map of the file."""
+    with open(path, "rb") as f:
+        mm = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+
+    magic, version, column_count, rows = HEADER.unpack_from(mm, 0)
+    if magic != b"STFEAT01" or version != 1:
+        raise ValueError("%s is not a SmartTrack feature file" % path)
+
+    columns = {}
+    for c in range(column_count):
+        name, col_type, _, offset = DESCRIPTOR.unpack_from(mm, HEADER.size + c * DESCRIPTOR.size)
+        name = name.rstrip(b"\0").decode()
+        columns[name] = np.frombuffer(mm, dtype=COLUMN_DTYPES[col_type], count=rows, offset=offset)
+    return columns
+
+
+def generate_csv(path, vehicles, hours, interval_s=1, seed=1):
+    """Write synthetic telemetry with overheat and low-voltage episodes."""
+    rng = random.Random(seed)
+    samples = int(hours * 3600 / interval_s)
+    with open(path, "w") as f:
+        f.write("vehicle_id,timestamp_ms,coolant_temp,battery_voltage,rpm,dtc\n")
+        for v in range(vehicles):
+            temp, volt, hot, low = 30.0, 12.6, False, False
+            for i in range(samples):
+                temp = min(max(temp + rng.uniform(-0.5, 0.55), 15.0), 60.0)
+                volt = min(max(volt + rng.uniform(-0.05, 0.05), 11.0), 13.0)
+                rpm = 800 + rng.randint(0, 3000)
+                dtc = ""
+                if (temp > COOLANT_HIGH_C) != hot:
+                    hot = not hot
+                    dtc = ("+" if hot else "-") + "P0118"
+                elif (volt < VOLTAGE_LOW_V) != low:
+                    low = not low
+                    dtc = ("+" if low else "-") + "P0562"
+                f.write("%d,%d,%.2f,%.2f,%d,%s\n" % (v, i * interval_s * 1000, temp, volt, rpm, dtc))
+
+
+def _windows(start, stop, hop_ms):
+    """Explode per-row window index ranges [start, stop] into (row, window start) pairs."""
+    counts = np.maximum(stop - start + 1, 0)
+    rows = np.repeat(np.arange(len(start)), counts)
+    offsets = np.arange(counts.sum()) - np.repeat(np.cumsum(counts) - counts, counts)
+    return rows, (np.repeat(start, counts) + offsets) * hop_ms
+
+
+def pandas_baseline(csv_path, window_s, hop_s):
+    """Single-threaded reference implementation of the same features."""
+    import pandas as pd
+
+    window_ms, hop_ms = window_s * 1000, hop_s * 1000
+    df = pd.read_csv(csv_path, dtype={"dtc": str}, keep_default_na=False)
+    df = df.sort_values(["vehicle_id", "timestamp_ms"], kind="stable").reset_index(drop=True)
+    by_vehicle = df.groupby("vehicle_id", sort=False)
+
+    next_ts = by_vehicle["timestamp_ms"].shift(-1)
+    df["hold"] = (next_ts - df["timestamp_ms"]).clip(upper=MAX_HOLD_MS).fillna(0).astype(np.int64)
+    prev_v = by_vehicle["battery_voltage"].shift(1).fillna(VOLTAGE_LOW_V)
+    df["dip"] = (df["battery_voltage"] < VOLTAGE_LOW_V) & (prev_v >= VOLTAGE_LOW_V)
+    df["onset"] = df["dtc"].str.startswith("+")
+
+    latency = np.full(len(df), -1, dtype=np.int64)
+    open_since = {}
+    for i, (vehicle, ts, dtc) in enumerate(zip(df["vehicle_id"], df["timestamp_ms"], df["dtc"])):
+        if dtc.startswith("+"):
+            open_since.setdefault((vehicle, dtc[1:]), ts)
+        elif dtc.startswith("-") and (vehicle, dtc[1:]) in open_since:
+            latency[i] = ts - open_since.pop((vehicle, dtc[1:]))
+    df["latency"] = latency
+    df["cleared"] = latency >= 0
+    df["latency_sum"] = np.where(latency >= 0, latency, 0)
+
+    # Rolling windows: a sample at t belongs to every window starting in (t - window, t]
+    ts = df["timestamp_ms"].to_numpy()
+    rows, starts = _windows((ts - window_ms) // hop_ms + 1, ts // hop_ms, hop_ms)
+    members = df.iloc[rows].reset_index(drop=True)
+    members["window_start_ms"] = starts
+    g = members.groupby(["vehicle_id", "window_start_ms"], sort=True)
+    out = g.agg(
+        sample_count=("coolant_temp", "size"),
+        coolant_mean=("coolant_temp", "mean"),
+        coolant_var=("coolant_temp", lambda x: x.var(ddof=0)),
+        voltage_mean=("battery_voltage", "mean"),
+        voltage_var=("battery_voltage", lambda x: x.var(ddof=0)),
+        rpm_mean=("rpm", "mean"),
+        rpm_var=("rpm", lambda x: x.var(ddof=0)),
+        voltage_dip_count=("dip", "sum"),
+        dtc_onset_count=("onset", "sum"),
+        dtc_clear_count=("cleared", "sum"),
+        latency_sum=("latency_sum", "sum"),
+        dtc_clear_latency_max_ms=("latency", "max"),
+    ).reset_index()
+
+    # Time past a limit: each sample's hold [t, t + hold) split over the windows it overlaps
+    hold = df["hold"].to_numpy()
+    rows, starts = _windows((ts - window_ms) // hop_ms + 1, (ts + hold - 1) // hop_ms, hop_ms)
+    overlap = np.minimum(ts[rows] + hold[rows], starts + window_ms) - np.maximum(ts[rows], starts)
+    spans = pd.DataFrame({
+        "vehicle_id": df["vehicle_id"].to_numpy()[rows],
+        "window_start_ms": starts,
+        "coolant_high_ms": np.where(df["coolant_temp"].to_numpy()[rows] > COOLANT_HIGH_C, overlap, 0),
+        "voltage_low_ms": np.where(df["battery_voltage"].to_numpy()[rows] < VOLTAGE_LOW_V, overlap, 0),
+    })
+    spans = spans.groupby(["vehicle_id", "window_start_ms"], sort=True).sum().reset_index()
+    out = out.merge(spans, on=["vehicle_id", "window_start_ms"], how="left").fillna(
+        {"coolant_high_ms": 0, "voltage_low_ms": 0})
+
+    out["dtc_clear_latency_mean_ms"] = np.where(
+        out["dtc_clear_count"] > 0, out["latency_sum"] / out["dtc_clear_count"].clip(lower=1), 0.0)
+    out["dtc_clear_latency_max_ms"] = out["dtc_clear_latency_max_ms"].clip(lower=0)
+    return out.drop(columns="latency_sum")
+
+
+def bench(args):
+    workdir = tempfile.mkdtemp(prefix="smarttrack_")
+    csv_path = os.path.join(workdir, "telemetry.csv")
+    out_path = os.path.join(workdir, "features.stf")
+
+    generate_csv(csv_path, args.vehicles, args.hours)
+    print("telemetry: %.1f MB" % (os.path.getsize(csv_path) / 1e6))
+
+    start = time.perf_counter()
+    subprocess.run([args.extractor, csv_path, out_path, str(args.window), str(args.hop)], check=True)
+    cpp_time = time.perf_counter() - start
+    features = load_features(out_path)
+
+    start = time.perf_counter()
+    reference = pandas_baseline(csv_path, args.window, args.hop)
+    pandas_time = time.perf_counter() - start
+
+    exact = ("vehicle_id", "window_start_ms", "sample_count", "coolant_high_ms", "voltage_low_ms",
+             "voltage_dip_count", "dtc_onset_count", "dtc_clear_count", "dtc_clear_latency_max_ms")
+    approx = ("coolant_mean", "coolant_var", "voltage_mean", "voltage_var", "rpm_mean", "rpm_var",
+              "dtc_clear_latency_mean_ms")
+    unchecked = set(features) - set(exact) - set(approx)
+    if unchecked:
+        raise SystemExit("no parity check for %s" % ", ".join(sorted(unchecked)))
+    for name in exact:
+        if not np.array_equal(features[name], reference[name].to_numpy().astype(features[name].dtype)):
+            raise SystemExit("mismatch in %s" % name)
+    for name in approx:
+        if not np.allclose(features[name], reference[name], rtol=1e-4, atol=1e-3):
+            raise SystemExit("mismatch in %s" % name)
+
+    print("rows: %d" % len(features["vehicle_id"]))
+    print("c++: %.3fs  pandas: %.3fs  speedup: %.1fx" % (cpp_time, pandas_time, pandas_time / cpp_time))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    b = sub.add_parser("bench", help="compare feature_extract with the pandas baseline")
+    b.add_argument("--extractor", default="./feature_extract")
+    b.add_argument("--vehicles", type=int, default=200)
+    b.add_argument("--hours", type=float, default=24)
+    b.add_argument("--window", type=int, default=3600)
+    b.add_argument("--hop", type=int, default=900)
+
+    s = sub.add_parser("show", help="print the columns of a feature file")
+    s.add_argument("path")
+
+    args = parser.parse_args()
+    if args.command == "bench":
+        bench(args)
+    else:
+        for name, column in load_features(args.path).items():
+            print("%-28s %-8s %s" % (name, column.dtype, column[:5]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,201 @@
+// Long-range query benchmark for the rollup tiers.
+//
+//   rollup_bench [vehicles] [days] [sample_period_s]
+//
+// Synthesises a fleet's telemetry (two drives a day sampled every
+// sample_period_s, 15-minute parked check-ins otherwise), rolls it up, and
+// times two quarter-long fleet reports against raw scans: daily max coolant
+// temperature per vehicle, and hours below 11.8 V per vehicle. Random
+// unaligned ranges are checked against the raw answer. A second store with
+// the default retention shows what is kept, and that a vehicle which stops
+// reporting ages out once expire() runs over the whole store.
+//
+// Build: g++ -O3 -march=native -fopenmp rollup_bench.cpp RollupStore.cpp TelemetryLog.cpp
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "RollupStore.h"
+#include "TelemetryLog.h"
+
+#define DAY_MS 86400000LL
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void synthesize(uint32_t vehicles, int days, int periodS, TelemetryLog& log) {
+  std::mt19937 rng(42);
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+  std::uniform_real_distribution<float> uni(0.0f, 1.0f);
+
+  for (uint32_t v = 0; v < vehicles; v++) {
+    for (int d = 0; d < days; d++) {
+      int64_t dayStart = (int64_t)d * DAY_MS;
+      int64_t trips[2][2] = {
+        {dayStart + (int64_t)(7.5 * 3600000) + (int64_t)(uni(rng) * 3600000), 0},
+        {dayStart + (int64_t)(17.0 * 3600000) + (int64_t)(uni(rng) * 3600000), 0},
+      };
+      for (auto& trip : trips) trip[1] = trip[0] + (int64_t)((0.5f + uni(rng)) * 3600000);
+      float hotDay = uni(rng) < 0.1f ? 6.0f : 0.0f;     // Some days run hot
+      float weakBattery = uni(rng) < 0.05f ? 0.9f : 0.0f;
+
+      int64_t t = dayStart;
+      while (t < dayStart + DAY_MS) {
+        bool driving = (t >= trips[0][0] && t < trips[0][1]) || (t >= trips[1][0] && t < trips[1][1]);
+        float coolant = driving ? 36.0f + hotDay * uni(rng) + 0.3f * noise(rng) : 22.0f + noise(rng);
+        float voltage = (driving ? 13.8f : 12.5f) - weakBattery + 0.05f * noise(rng);
+        float rpm = driving ? 1800.0f + 900.0f * noise(rng) : 0.0f;
+        log.vehicleId.push_back(v);
+        log.timestampMs.push_back(t);
+        log.coolantTemp.push_back(coolant);
+        log.batteryVoltage.push_back(voltage);
+        log.rpm.push_back(rpm < 0 ? 0 : rpm);
+        log.dtcAction.push_back(DTC_NONE);
+        log.dtcCode.push_back(0);
+        t += driving ? periodS * 1000LL : 900000LL;
+        // Start sampling at the trip start rather than at the next check-in
+        for (auto& trip : trips) {
+          if (!driving && t > trip[0] && t - 900000LL < trip[0]) t = trip[0];
+        }
+      }
+    }
+  }
+}
+
+static bool sameStats(const RollupStats& a, const RollupStats& b) {
+  return a.count == b.count && a.min == b.min && a.max == b.max &&
+         a.beyondMs == b.beyondMs && a.coveredMs == b.coveredMs &&
+         std::fabs(a.sum - b.sum) <= 1e-9 * (std::fabs(a.sum) + 1.0);
+}
+
+int main(int argc, char** argv) {
+  uint32_t vehicles = argc > 1 ? (uint32_t)std::atol(argv[1]) : 20;
+  int days = argc > 2 ? std::atoi(argv[2]) : 92;
+  int periodS = argc > 3 ? std::atoi(argv[3]) : 1;
+  if (vehicles == 0 || days <= 0 || periodS <= 0) {
+    std::fprintf(stderr, "usage: %s [vehicles] [days] [sample_period_s]\n", argv[0]);
+    return 2;
+  }
+
+  TelemetryLog log;
+  synthesize(vehicles, days, periodS, log);
+  std::printf("samples: %zu (%u vehicles, %d days)\n", log.size(), vehicles, days);
+
+  // Keep everything so the raw scans can run over the whole quarter
+  RollupRetention keepAll = RollupRetention();
+  RollupStore store(keepAll);
+  auto start = std::chrono::steady_clock::now();
+  size_t accepted = store.ingest(log);
+  double ingestS = secondsSince(start);
+  std::printf("ingest: %.2f s, %.1f M samples/s, %zu accepted\n", ingestS, accepted / ingestS / 1e6, accepted);
+  std::printf("buckets: minute %zu  hour %zu  day %zu\n",
+              store.bucketCount(ROLLUP_MINUTE), store.bucketCount(ROLLUP_HOUR), store.bucketCount(ROLLUP_DAY));
+
+  const int64_t from = 0;
+  const int64_t to = (int64_t)days * DAY_MS;
+  std::string error;
+
+  // Daily max coolant temperature per vehicle
+  std::vector<std::vector<RollupStats>> tiered(vehicles), raw(vehicles);
+  start = std::chrono::steady_clock::now();
+  for (uint32_t v = 0; v < vehicles; v++) {
+    if (!store.queryGrouped(v, ROLLUP_COOLANT, from, to, DAY_MS, tiered[v], error)) {
+      std::fprintf(stderr, "query: %s\n", error.c_str());
+      return 1;
+    }
+  }
+  double tieredS = secondsSince(start);
+  start = std::chrono::steady_clock::now();
+  for (uint32_t v = 0; v < vehicles; v++) {
+    for (int64_t g = from; g < to; g += DAY_MS) {
+      RollupStats s;
+      store.scanRaw(v, ROLLUP_COOLANT, g, g + DAY_MS, s, error);
+      raw[v].push_back(s);
+    }
+  }
+  double rawS = secondsSince(start);
+  bool match = true;
+  for (uint32_t v = 0; v < vehicles; v++) {
+    for (size_t d = 0; d < raw[v].size(); d++) match = match && sameStats(tiered[v][d], raw[v][d]);
+  }
+  std::printf("daily max coolant: tiers %.3f ms  raw %.1f ms  %.0fx  %s\n",
+              tieredS * 1e3, rawS * 1e3, rawS / tieredS, match ? "identical" : "MISMATCH");
+
+  // Hours below 11.8 V per vehicle over the quarter
+  double lowHours = 0;
+  start = std::chrono::steady_clock::now();
+  std::vector<RollupStats> lowTiered(vehicles), lowRaw(vehicles);
+  for (uint32_t v = 0; v < vehicles; v++) {
+    store.query(v, ROLLUP_VOLTAGE, from, to, lowTiered[v], error);
+    lowHours += lowTiered[v].beyondMs / 3.6e6;
+  }
+  tieredS = secondsSince(start);
+  start = std::chrono::steady_clock::now();
+  for (uint32_t v = 0; v < vehicles; v++) store.scanRaw(v, ROLLUP_VOLTAGE, from, to, lowRaw[v], error);
+  rawS = secondsSince(start);
+  match = true;
+  for (uint32_t v = 0; v < vehicles; v++) match = match && sameStats(lowTiered[v], lowRaw[v]);
+  std::printf("hours below 11.8 V: tiers %.3f ms  raw %.1f ms  %.0fx  %s  (fleet total %.1f h)\n",
+              tieredS * 1e3, rawS * 1e3, rawS / tieredS, match ? "identical" : "MISMATCH", lowHours);
+
+  // Unaligned ranges use finer tiers and raw samples at the edges
+  std::mt19937_64 rng(7);
+  int mismatches = 0;
+  RollupPlan plan = RollupPlan();
+  uint64_t rawRead = 0, bucketsRead = 0;
+  const int checks = 2000;
+  for (int i = 0; i < checks; i++) {
+    uint32_t v = (uint32_t)(rng() % vehicles);
+    int field = (int)(rng() % ROLLUP_FIELDS);
+    int64_t a = (int64_t)(rng() % (uint64_t)to);
+    int64_t b = a + 1 + (int64_t)(rng() % (uint64_t)(to - a));
+    RollupStats t, r;
+    store.query(v, field, a, b, t, error, &plan);
+    store.scanRaw(v, field, a, b, r, error);
+    if (!sameStats(t, r)) mismatches++;
+    rawRead += plan.rawSamples;
+    bucketsRead += plan.buckets[ROLLUP_MINUTE] + plan.buckets[ROLLUP_HOUR] + plan.buckets[ROLLUP_DAY];
+  }
+  std::printf("random ranges: %d checked, %d mismatches, avg %.0f buckets + %.0f raw samples read\n",
+              checks, mismatches, (double)bucketsRead / checks, (double)rawRead / checks);
+
+  // Default retention: raw and minute buckets age out, day-aligned reports still work
+  RollupStore retained;
+  retained.ingest(log);
+  std::printf("default retention: raw %zu  minute %zu  hour %zu  day %zu\n",
+              retained.rawSampleCount(), retained.bucketCount(ROLLUP_MINUTE),
+              retained.bucketCount(ROLLUP_HOUR), retained.bucketCount(ROLLUP_DAY));
+  RollupStats quarter;
+  bool aligned = retained.query(0, ROLLUP_VOLTAGE, from, to, quarter, error);
+  bool unaligned = retained.query(0, ROLLUP_VOLTAGE, from + 1, to, quarter, error);
+  std::printf("  quarter aligned to days: %s; starting 1 ms past midnight: %s\n",
+              aligned ? "answered" : "refused", unaligned ? "answered" : ("refused (" + error + ")").c_str());
+
+  // A vehicle that stops reporting a third of the way in keeps its raw and
+  // minute data until a store-wide expire() catches up with it
+  TelemetryLog silentLog;
+  int silentDays = days / 3 > 0 ? days / 3 : 1;
+  synthesize(1, silentDays, periodS, silentLog);
+  for (uint32_t& id : silentLog.vehicleId) id = vehicles;
+  retained.ingest(silentLog);
+  const int64_t lastHour = (int64_t)silentDays * DAY_MS - 3600000LL;
+  std::string silentError;
+  bool recentBefore = retained.query(vehicles, ROLLUP_VOLTAGE, lastHour + 1, lastHour + 600000, quarter, silentError);
+  std::printf("silent vehicle (%d days): raw %zu  minute %zu  hour %zu; its last hour %s\n", silentDays,
+              retained.rawSampleCount(), retained.bucketCount(ROLLUP_MINUTE), retained.bucketCount(ROLLUP_HOUR),
+              recentBefore ? "answered" : "refused");
+  retained.expire(to);
+  bool recentAfter = retained.query(vehicles, ROLLUP_VOLTAGE, lastHour + 1, lastHour + 600000, quarter, silentError);
+  bool silentAligned = retained.query(vehicles, ROLLUP_VOLTAGE, from, to, quarter, silentError);
+  std::printf("after expire(day %d): raw %zu  minute %zu  hour %zu; its last hour %s, its quarter %s\n", days,
+              retained.rawSampleCount(), retained.bucketCount(ROLLUP_MINUTE), retained.bucketCount(ROLLUP_HOUR),
+              recentAfter ? "answered" : "refused", silentAligned ? "answered" : "refused");
+  // Raw data is gone once the silent vehicle is older than the raw retention
+  bool expired = silentAligned && (recentAfter == ((int64_t)(days - silentDays) * DAY_MS <= 7 * DAY_MS));
+  if (!expired) std::printf("  store-wide expire did not age out the silent vehicle\n");
+  return mismatches == 0 && expired ? 0 : 1;
+}
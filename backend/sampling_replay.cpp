@@ -0,0 +1,271 @@
+// Replay benchmark for the firmware's adaptive sampling controller.
+//
+//   sampling_replay [hours] [fixed_period_ms] [seed] [blocking: none|wokwi|field]
+//
+// Synthesises a 10 Hz ground-truth trace of coolant temperature and battery
+// voltage (long stable stretches, overheating spikes, voltage dips), then
+// samples it two ways: both signals and a telemetry frame every
+// fixed_period_ms, as the firmware used to, and through AdaptiveSampler with
+// the firmware's signal settings and the same budget, charging a frame for
+// every window that took a sample. Reports cost, reconstruction error (last
+// sample held) overall and near the thresholds, and how quickly each
+// threshold crossing is seen.
+//
+// While a DTC is active the firmware's cycle blocks: sendAlert() holds the
+// buzzer for 2 s per signal in alarm, updateLCD() pages through the DTCs
+// (2 s + 2 s each + 2 s), and on the field board the two SMS are followed
+// by a 10 s delay. No signal is read meanwhile. "wokwi" and "field" model
+// those delays for that board in both runs; "none" (the default) leaves
+// them out and says so.
+//
+// Build: g++ -O2 sampling_replay.cpp -o sampling_replay
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../codes/src/AdaptiveSampler.h"
+
+#define TRUTH_STEP_MS 100
+
+struct Trace {
+  std::vector<int32_t> coolant;   // Hundredths of a degree
+  std::vector<int32_t> battery;   // Hundredths of a volt
+};
+
+static Trace synthesize(double hours, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::normal_distribution<double> noise(0.0, 1.0);
+  std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+  size_t n = (size_t)(hours * 3600 * 1000 / TRUTH_STEP_MS);
+  Trace t;
+  t.coolant.resize(n);
+  t.battery.resize(n);
+
+  double temp = 34.0;
+  double spikeLeft = 0, spikePeak = 0;      // Overheating episode: seconds left, peak
+  double volt = 12.6;
+  double dipLeft = 0, dipDepth = 0;         // Voltage dip: seconds left, depth
+  const double dt = TRUTH_STEP_MS / 1000.0;
+
+  for (size_t i = 0; i < n; i++) {
+    // About four overheating episodes per hour, ramping up for 40-120 s
+    if (spikeLeft <= 0 && uni(rng) < 4.0 / 3600 * dt) {
+      spikeLeft = 40 + 80 * uni(rng);
+      spikePeak = 39.0 + 6.0 * uni(rng);
+    }
+    double target = 34.0;
+    if (spikeLeft > 0) {
+      target = spikePeak;
+      spikeLeft -= dt;
+    }
+    temp += (target - temp) * 0.05 * dt + 0.02 * noise(rng);
+
+    // About six voltage dips per hour, lasting 2-10 s
+    if (dipLeft <= 0 && uni(rng) < 6.0 / 3600 * dt) {
+      dipLeft = 2 + 8 * uni(rng);
+      dipDepth = 0.5 + 1.0 * uni(rng);
+    }
+    double vTarget = 12.6;
+    if (dipLeft > 0) {
+      vTarget = 12.6 - dipDepth;
+      dipLeft -= dt;
+    }
+    volt += (vTarget - volt) * 2.0 * dt + 0.005 * noise(rng);
+
+    t.coolant[i] = (int32_t)std::lround(temp * 100);
+    t.battery[i] = (int32_t)std::lround(volt * 100);
+  }
+  return t;
+}
+
+struct SignalScore {
+  uint64_t samples = 0;
+  double sqErr = 0;
+  uint64_t points = 0;
+  double nearSqErr = 0;       // Only where the truth is within nearBand of, or past, the threshold
+  uint64_t nearPoints = 0;
+  uint32_t episodes = 0;      // Threshold crossings in the truth
+  uint32_t missed = 0;        // Crossings no sample ever saw
+  double latencyMs = 0;       // Summed over detected crossings
+};
+
+static bool inAlarm(const SignalConfig& c, int32_t v) {
+  return c.alarmBelow ? v < c.threshold : v > c.threshold;
+}
+
+static bool isNear(const SignalConfig& c, int32_t v) {
+  int32_t margin = c.alarmBelow ? v - c.threshold : c.threshold - v;
+  return margin < c.nearBand;
+}
+
+// Track error and crossing detection for one signal as samples arrive
+class Scorer {
+public:
+  explicit Scorer(const SignalConfig& c) : config(c) {}
+
+  void step(uint32_t nowMs, int32_t truth, bool sampled) {
+    if (sampled) {
+      held = truth;
+      hasSample = true;
+      score.samples++;
+    }
+    if (hasSample) {
+      double e = (double)(held - truth);
+      score.sqErr += e * e;
+      score.points++;
+      if (isNear(config, truth)) {
+        score.nearSqErr += e * e;
+        score.nearPoints++;
+      }
+    }
+
+    bool alarm = inAlarm(config, truth);
+    if (alarm && !inEpisode) {
+      inEpisode = true;
+      detected = false;
+      episodeStartMs = nowMs;
+      score.episodes++;
+    }
+    if (inEpisode && !detected && sampled && inAlarm(config, held)) {
+      detected = true;
+      score.latencyMs += nowMs - episodeStartMs;
+    }
+    if (inEpisode && clearOf(truth)) {
+      inEpisode = false;
+      if (!detected) score.missed++;
+    }
+  }
+
+  SignalScore score;
+
+private:
+  // A crossing ends once the truth is back by a tenth of the near band, so sensor noise
+  // around the threshold is not counted as many crossings
+  bool clearOf(int32_t v) const {
+    int32_t margin = config.alarmBelow ? v - config.threshold : config.threshold - v;
+    return margin > config.nearBand / 10;
+  }
+
+  const SignalConfig& config;
+  int32_t held = 0;
+  bool hasSample = false;
+  bool inEpisode = false;
+  bool detected = false;
+  uint32_t episodeStartMs = 0;
+};
+
+enum Blocking { BLOCK_NONE, BLOCK_WOKWI, BLOCK_FIELD };
+
+// How long runCycle() blocks after a window, given the DTCs it leaves active
+// (the last reading of each signal past its threshold)
+static uint32_t blockedMs(Blocking board, bool coolantAlarm, bool batteryAlarm) {
+  uint32_t dtcs = (uint32_t)coolantAlarm + (uint32_t)batteryAlarm;
+  if (board == BLOCK_NONE || dtcs == 0) return 0;
+  uint32_t ms = 2000 * dtcs;              // sendAlert() per signal
+  ms += 2000 + 2000 * dtcs + 2000;        // updateLCD() DTC pages
+  if (board == BLOCK_FIELD) ms += 2 * 300 + 10000;   // Two SMS, then the post-SMS delay
+  return ms;
+}
+
+static void report(const char* name, const SignalScore& s, double hours, double scale) {
+  double detectedCount = s.episodes - s.missed;
+  std::printf("  %-8s samples/h %8.0f  rms %6.3f  rms near threshold %6.3f  crossings %4u  missed %3u  mean latency %6.0f ms\n",
+              name, s.samples / hours,
+              s.points ? std::sqrt(s.sqErr / s.points) / scale : 0.0,
+              s.nearPoints ? std::sqrt(s.nearSqErr / s.nearPoints) / scale : 0.0,
+              s.episodes, s.missed, detectedCount > 0 ? s.latencyMs / detectedCount : 0.0);
+}
+
+int main(int argc, char** argv) {
+  double hours = argc > 1 ? std::atof(argv[1]) : 24;
+  uint32_t fixedPeriod = argc > 2 ? (uint32_t)std::atol(argv[2]) : 1000;
+  unsigned seed = argc > 3 ? (unsigned)std::atol(argv[3]) : 1;
+  std::string blockArg = argc > 4 ? argv[4] : "none";
+  Blocking board = blockArg == "field" ? BLOCK_FIELD : blockArg == "wokwi" ? BLOCK_WOKWI : BLOCK_NONE;
+  if (hours <= 0 || fixedPeriod < TRUTH_STEP_MS || fixedPeriod % TRUTH_STEP_MS != 0 ||
+      (board == BLOCK_NONE && blockArg != "none")) {
+    std::fprintf(stderr, "usage: %s [hours] [fixed_period_ms, multiple of %d] [seed] [none|wokwi|field]\n",
+                 argv[0], TRUTH_STEP_MS);
+    return 2;
+  }
+
+  Trace trace = synthesize(hours, seed);
+  size_t n = trace.coolant.size();
+
+  const SignalConfig coolantConfig = coolantSignalConfig(fixedPeriod);
+  const SignalConfig batteryConfig = batterySignalConfig(fixedPeriod);
+
+  // Fixed rate: both signals every window, the next one a period later or
+  // once the cycle stops blocking
+  Scorer fixedCoolant(coolantConfig), fixedBattery(batteryConfig);
+  uint32_t nextTake = 0;
+  uint64_t fixedBlockedMs = 0;
+  for (size_t i = 0; i < n; i++) {
+    uint32_t now = (uint32_t)(i * TRUTH_STEP_MS);
+    bool take = now >= nextTake;
+    if (take) {
+      uint32_t blocked = blockedMs(board, inAlarm(coolantConfig, trace.coolant[i]),
+                                   inAlarm(batteryConfig, trace.battery[i]));
+      fixedBlockedMs += blocked;
+      nextTake = now + (blocked > fixedPeriod ? blocked : fixedPeriod);
+    }
+    fixedCoolant.step(now, trace.coolant[i], take);
+    fixedBattery.step(now, trace.battery[i], take);
+  }
+  double fixedCost = (double)fixedCoolant.score.samples * (COOLANT_SAMPLE_COST + TELEMETRY_FRAME_COST)
+                   + (double)fixedBattery.score.samples * BATTERY_SAMPLE_COST;
+
+  // Adaptive, with the budget the fixed rate would spend
+  AdaptiveSampler sampler(SMARTTRACK_WINDOW_COST, fixedPeriod);
+  int coolant = sampler.addSignal(coolantConfig);
+  int battery = sampler.addSignal(batteryConfig);
+  Scorer adaptCoolant(coolantConfig), adaptBattery(batteryConfig);
+  uint32_t blockedUntil = 0;
+  uint64_t adaptBlockedMs = 0;
+  int32_t lastCoolant = 0, lastBattery = batteryConfig.threshold + batteryConfig.nearBand;
+  for (size_t i = 0; i < n; i++) {
+    uint32_t now = (uint32_t)(i * TRUTH_STEP_MS);
+    uint8_t mask = now >= blockedUntil ? sampler.due(now) : 0;
+    bool takeCoolant = mask & (1 << coolant);
+    bool takeBattery = mask & (1 << battery);
+    if (takeCoolant) {
+      sampler.record(coolant, now, trace.coolant[i]);
+      lastCoolant = trace.coolant[i];
+    }
+    if (takeBattery) {
+      sampler.record(battery, now, trace.battery[i]);
+      lastBattery = trace.battery[i];
+    }
+    if (mask) {
+      sampler.charge(now, TELEMETRY_FRAME_COST);
+      uint32_t blocked = blockedMs(board, inAlarm(coolantConfig, lastCoolant), inAlarm(batteryConfig, lastBattery));
+      adaptBlockedMs += blocked;
+      blockedUntil = now + blocked;
+    }
+    adaptCoolant.step(now, trace.coolant[i], takeCoolant);
+    adaptBattery.step(now, trace.battery[i], takeBattery);
+  }
+  const SamplerStats& stats = sampler.statistics();
+
+  std::printf("trace: %.1f h at %d ms, seed %u\n", hours, TRUTH_STEP_MS, seed);
+  if (board == BLOCK_NONE) {
+    std::printf("blocking: not modelled; alert, LCD and SMS delays while a DTC is active are left out\n");
+  } else {
+    std::printf("blocking: %s board delays while a DTC is active; blocked %.1f%% of the time fixed, %.1f%% adaptive\n",
+                board == BLOCK_FIELD ? "field" : "wokwi", 100.0 * fixedBlockedMs / (n * TRUTH_STEP_MS),
+                100.0 * adaptBlockedMs / (n * TRUTH_STEP_MS));
+  }
+  std::printf("fixed %u ms: cost/h %.0f\n", fixedPeriod, fixedCost / hours);
+  report("coolant", fixedCoolant.score, hours, 100.0);
+  report("battery", fixedBattery.score, hours, 100.0);
+  std::printf("adaptive: cost/h %.0f (%.0f%% of fixed), deferred %u\n",
+              stats.spent / hours, 100.0 * stats.spent / fixedCost, stats.deferred);
+  report("coolant", adaptCoolant.score, hours, 100.0);
+  report("battery", adaptBattery.score, hours, 100.0);
+  return 0;
+}
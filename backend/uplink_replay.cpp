@@ -0,0 +1,118 @@
+// Drive the device uplink on Linux against a broker (e.g. mock_broker).
+//
+//   uplink_replay [host] [port] [frames_per_second] [seconds]
+//
+// Generates telemetry like the firmware's loop(), plus a heap/stack sample
+// every 10 seconds and a trip summary every minute, and prints the uplink's counters once a second, so
+// back-pressure and reconnects can be watched while mock_broker slows acks
+// or drops the connection. To test broker credentials, build with
+// -DUPLINK_USERNAME='"user"' -DUPLINK_PASSWORD='"pass"' and start
+// mock_broker with the same --user and --password.
+//
+// Build: g++ -O2 uplink_replay.cpp -o uplink_replay
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+static const char* brokerHost = "127.0.0.1";
+static int brokerPort = 1883;
+
+#define UPLINK_BROKER_HOST brokerHost
+#define UPLINK_BROKER_PORT brokerPort
+#define UPLINK_BATCH_MS 1000
+#include "../codes/src/Uplink.h"
+#include "PosixClient.h"
+
+int main(int argc, char** argv) {
+  if (argc > 1) brokerHost = argv[1];
+  if (argc > 2) brokerPort = std::atoi(argv[2]);
+  double rate = argc > 3 ? std::atof(argv[3]) : 50;
+  double seconds = argc > 4 ? std::atof(argv[4]) : 30;
+  if (rate <= 0 || seconds <= 0) {
+    std::fprintf(stderr, "usage: %s [host] [port] [frames_per_second] [seconds]\n", argv[0]);
+    return 2;
+  }
+
+  PosixClient client;
+  Uplink<PosixClient> uplink(client);
+  std::mt19937 rng(1);
+
+  auto begin = std::chrono::steady_clock::now();
+  auto millis = [&]() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - begin).count();
+  };
+
+  TelemetryFrame frame = TelemetryFrame();
+  frame.rpm = 1200;
+  frame.coolantDeci = 820;
+  frame.voltageCenti = 1260;
+  frame.fuelPct = 75;
+  frame.latE7 = 129715980;
+  frame.lonE7 = 775945660;
+
+  // A slowly leaking heap and two tracked task stacks
+  MemoryRecord memory = MemoryRecord();
+  memory.freeHeap = 180000;
+  memory.minFreeHeap = memory.freeHeap;
+  memory.stackCount = 2;
+  memory.stackHighWater[0] = 5200;
+  memory.stackHighWater[1] = 1900;
+
+  TripRecord trip = TripRecord();
+  uint32_t nextTrip = 60000;
+
+  uint64_t frames = 0;
+  uint32_t nextReport = 1000;
+  uint32_t nextMemory = 0;
+  bool overheated = false;
+  while (millis() < seconds * 1000) {
+    uint32_t now = millis();
+    while (frames < (uint64_t)(now * rate / 1000)) {
+      frame.timeMs = now;
+      frame.rpm = (uint16_t)(800 + rng() % 2000);
+      frame.coolantDeci = (int16_t)(frame.coolantDeci + (int)(rng() % 11) - 5);
+      frame.speedKmh = (uint8_t)(rng() % 120);
+      frame.latE7 += (int32_t)(rng() % 200) - 100;
+      frame.lonE7 += (int32_t)(rng() % 200) - 100;
+      uplink.offerTelemetry(frame);
+      if ((frame.coolantDeci > 400) != overheated) {
+        overheated = !overheated;
+        uplink.offerDTC(now, 0x0118, overheated);
+      }
+      frames++;
+    }
+    if (now >= nextMemory) {
+      memory.freeHeap -= rng() % 64;
+      memory.largestBlock = memory.freeHeap - memory.freeHeap / 8 - rng() % 4096;
+      memory.fragmentationPct = (uint8_t)(100 - (uint64_t)memory.largestBlock * 100 / memory.freeHeap);
+      if (memory.freeHeap < memory.minFreeHeap) memory.minFreeHeap = memory.freeHeap;
+      uplink.offerMemory(now, memory);
+      nextMemory += 10000;
+    }
+    if (now >= nextTrip) {
+      trip.durationS = 60;
+      trip.drivingS = 55;
+      trip.distanceM = 900 + rng() % 200;
+      trip.harshBrakeCount = (uint16_t)(rng() % 3);
+      trip.score = (uint8_t)(100 - 4 * trip.harshBrakeCount);
+      uplink.offerTrip(now, trip);
+      nextTrip += 60000;
+    }
+    uplink.poll(now);
+
+    if (now >= nextReport) {
+      const UplinkStats& s = uplink.stats();
+      std::printf("t=%us frames=%llu acked=%u dropped=%u resends=%u reconnects=%u refused=%u bytes=%u %s%s\n",
+                  now / 1000, (unsigned long long)frames, s.recordsAcked, s.recordsDropped,
+                  s.resends, s.reconnects, s.refused, s.bytesSent, uplink.connected() ? "up" : "down",
+                  uplink.backlogged() ? " backlogged" : "");
+      nextReport += 1000;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  return 0;
+}
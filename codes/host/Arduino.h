@@ -0,0 +1,145 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Minimal Arduino API for building the firmware on a PC with
+// SMARTTRACK_BOARD = BOARD_HOST (see host_harness.cpp).
+// Covers only what codes/src uses on a board with no peripherals. Time is
+// simulated: millis() advances only through delay() and hostAdvance(), so
+// runs are deterministic.
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLDOWN 9
+#define DEC 10
+#define HEX 16
+
+// Simulated clock and pins
+inline unsigned long& hostMillis() {
+  static unsigned long now = 0;
+  return now;
+}
+inline void hostAdvance(unsigned long ms) { hostMillis() += ms; }
+inline unsigned long millis() { return hostMillis(); }
+inline void delay(unsigned long ms) { hostAdvance(ms); }
+
+inline int& hostAnalogValue() {
+  static int value = 2048;
+  return value;
+}
+inline int analogRead(uint8_t) { return hostAnalogValue(); }
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return LOW; }
+
+inline long random(long low, long high) { return high > low ? low + rand() % (high - low) : low; }
+inline long random(long high) { return random(0, high); }
+inline long map(long x, long inLow, long inHigh, long outLow, long outHigh) {
+  return (x - inLow) * (outHigh - outLow) / (inHigh - inLow) + outLow;
+}
+
+class String {
+public:
+  String() {}
+  String(const char* text) : s(text ? text : "") {}
+  String(const std::string& text) : s(text) {}
+  String(char c) : s(1, c) {}
+  String(int value) : s(std::to_string(value)) {}
+  String(unsigned int value) : s(std::to_string(value)) {}
+  String(long value) : s(std::to_string(value)) {}
+  String(unsigned long value) : s(std::to_string(value)) {}
+  String(float value, unsigned int decimals = 2) : s(format(value, decimals)) {}
+  String(double value, unsigned int decimals = 2) : s(format(value, decimals)) {}
+
+  unsigned int length() const { return (unsigned int)s.size(); }
+  const char* c_str() const { return s.c_str(); }
+  long toInt() const { return atol(s.c_str()); }
+  float toFloat() const { return (float)atof(s.c_str()); }
+  bool startsWith(const String& prefix) const { return s.compare(0, prefix.s.size(), prefix.s) == 0; }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > s.size()) return String();
+    return String(s.substr(from, to > from ? to - from : 0));
+  }
+
+  bool operator==(const String& other) const { return s == other.s; }
+  bool operator!=(const String& other) const { return s != other.s; }
+  bool operator==(const char* other) const { return s == other; }
+  bool operator!=(const char* other) const { return s != other; }
+  String& operator+=(const String& other) { s += other.s; return *this; }
+  friend String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+  friend String operator+(const String& a, const char* b) { return String(a.s + b); }
+  friend String operator+(const char* a, const String& b) { return String(a + b.s); }
+
+private:
+  static std::string format(double value, unsigned int decimals) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, value);
+    return buf;
+  }
+
+  std::string s;
+};
+
+// Output sink; everything goes through write()
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* data, size_t n) {
+    for (size_t i = 0; i < n; i++) write(data[i]);
+    return n;
+  }
+
+  size_t print(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+  size_t print(const String& text) { return print(text.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int value, int base = DEC) { return print((long)value, base); }
+  size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(long value, int base = DEC) { return printf(base == HEX ? "%lX" : "%ld", value); }
+  size_t print(unsigned long value, int base = DEC) { return printf(base == HEX ? "%lX" : "%lu", value); }
+  size_t print(double value, int decimals = 2) { return printf("%.*f", decimals, value); }
+
+  template <typename T> size_t println(const T& value) { return print(value) + println(); }
+  template <typename T> size_t println(const T& value, int format) { return print(value, format) + println(); }
+  size_t println() { return print("\r\n"); }
+
+private:
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+inline size_t Print::printf(const char* format, ...) {
+  char buf[64];
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  return n > 0 ? print(buf) : 0;
+}
+
+// Serial console, written to stdout when echo is on
+class HardwareSerial : public Print {
+public:
+  HardwareSerial() : echo(false) {}
+  void begin(unsigned long) {}
+  void flush() { fflush(stdout); }
+  size_t write(uint8_t c) override {
+    if (echo) putchar(c);
+    return 1;
+  }
+  using Print::write;
+
+  bool echo;
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,68 @@
+// Host harness: runs the shared firmware with SMARTTRACK_BOARD = BOARD_HOST
+// against the Arduino shim in this directory, on a simulated clock.
+//
+//   host_harness [-v]
+//
+// Drives the coolant temperature (through TemperatureSensor::setSimulated)
+// and the battery potentiometer through an overheating episode and a
+// voltage sag, and checks that P0118 and P0562 are raised and cleared.
+// -v echoes the firmware's serial output.
+//
+// Build: g++ -std=c++11 -Icodes/host codes/host/host_harness.cpp -o host_harness
+
+#define SMARTTRACK_BOARD BOARD_HOST
+#include "../src/SmartTrack.h"
+
+HardwareSerial Serial;
+
+#define RUN_MS 900000UL    // 15 simulated minutes
+
+// Coolant temperature over the run: warm-up, overheating from 4 to 7 minutes, recovery
+static float coolantAt(unsigned long ms) {
+  float minutes = ms / 60000.0f;
+  if (minutes < 2) return 25 + 5 * minutes;
+  if (minutes < 4) return 35 + 4 * (minutes - 2);
+  if (minutes < 7) return 44;
+  if (minutes < 9) return 44 - 5 * (minutes - 7);
+  return 34;
+}
+
+// Potentiometer reading: 12.4 V, sagging to 11.2 V from 10 to 12 minutes
+static int potAt(unsigned long ms) {
+  bool sag = ms >= 600000UL && ms < 720000UL;
+  return sag ? 410 : 2867;
+}
+
+static bool dtcActive(const char* code) {
+  for (int i = 0; i < 3; i++) {
+    if (activeDTCs[i].startsWith(code)) return true;
+  }
+  return false;
+}
+
+int main(int argc, char** argv) {
+  Serial.echo = argc > 1 && strcmp(argv[1], "-v") == 0;
+  debugMode = Serial.echo;
+
+  setup();
+  unsigned long overheatSeenMs = 0, sagSeenMs = 0;
+  unsigned long passes = 0;
+  while (millis() < RUN_MS) {
+    tempSensor.setSimulated(coolantAt(millis()));
+    hostAnalogValue() = potAt(millis());
+    loop();
+    passes++;
+    if (!overheatSeenMs && dtcActive("P0118")) overheatSeenMs = millis();
+    if (!sagSeenMs && dtcActive("P0562")) sagSeenMs = millis();
+  }
+
+  bool ok = overheatSeenMs && sagSeenMs && !dtcActive("P0118") && !dtcActive("P0562");
+  printf("passes: %lu over %lu s simulated\n", passes, millis() / 1000);
+  printf("P0118 raised at %lu s, P0562 raised at %lu s, active at end: %s\n",
+         overheatSeenMs / 1000, sagSeenMs / 1000, hasDTCs ? activeDTCs[0].c_str() : "none");
+  printf("coolant samples %u, battery samples %u, driver score %u, position +/-%um\n",
+         sampler.statistics().samples[coolantSignal], sampler.statistics().samples[batterySignal],
+         driverBehavior.score(), (unsigned)positionFilter.errorRadiusM());
+  printf("%s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
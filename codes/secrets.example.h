@@ -0,0 +1,17 @@
+// Network settings for the field build.
+// Copy to codes/secrets.h (ignored by git) and fill in; the build stops
+// with an error until they are defined.
+
+#define SMARTTRACK_WIFI_SSID     "your-network"
+#define SMARTTRACK_WIFI_PASSWORD "your-password"
+#define UPLINK_BROKER_HOST       "broker.your-fleet.example"
+// #define UPLINK_BROKER_PORT    1883
+// #define UPLINK_DEVICE_ID      "smarttrack-001"
+// #define UPLINK_USERNAME       "smarttrack-001"
+// #define UPLINK_PASSWORD       "broker-password"
+
+// TLS to the broker (port 8883 unless UPLINK_BROKER_PORT says otherwise)
+// #define UPLINK_TLS            1
+// #define UPLINK_CA_CERT        "-----BEGIN CERTIFICATE-----\n" \
+//                               "...\n" \
+//                               "-----END CERTIFICATE-----\n"
@@ -0,0 +1,86 @@
+#ifndef BOARD_PROFILE_H
+#define BOARD_PROFILE_H
+
+// Compile-time board profiles.
+// Each entry point defines SMARTTRACK_BOARD before including SmartTrack.h.
+// Peripherals a board does not have are compiled out (see Peripherals.h),
+// so there is no runtime check for hardware presence.
+
+#define BOARD_ESP32_FIELD  1    // ESP32 with NEO-6M GPS, SIM800L GSM, I2C LCD and WiFi uplink
+#define BOARD_WOKWI        2    // Wokwi simulation: DS18B20, LCD and WiFi, no GPS/GSM
+#define BOARD_HOST         3    // Host harness build against the Arduino shim in codes/host, no peripherals
+
+#ifndef SMARTTRACK_BOARD
+#define SMARTTRACK_BOARD BOARD_ESP32_FIELD
+#endif
+
+#if SMARTTRACK_BOARD == BOARD_ESP32_FIELD
+  #define BOARD_HAS_TEMP_SENSOR  1
+  #define BOARD_HAS_GPS          1
+  #define BOARD_HAS_GSM          1
+  #define BOARD_HAS_LCD          1
+  #define BOARD_HAS_WIFI         1
+  // Network settings come from codes/secrets.h (see codes/secrets.example.h)
+  #if !defined(SMARTTRACK_WIFI_SSID) || !defined(SMARTTRACK_WIFI_PASSWORD)
+    #error "Field build needs SMARTTRACK_WIFI_SSID and SMARTTRACK_WIFI_PASSWORD in codes/secrets.h"
+  #endif
+  #if !defined(UPLINK_BROKER_HOST)
+    #error "Field build needs UPLINK_BROKER_HOST in codes/secrets.h"
+  #endif
+  #define BOARD_WIFI_SSID        SMARTTRACK_WIFI_SSID
+  #define BOARD_WIFI_PASSWORD    SMARTTRACK_WIFI_PASSWORD
+  // Optional TLS to the broker: UPLINK_TLS 1 and the broker's CA as UPLINK_CA_CERT
+  #ifndef UPLINK_TLS
+    #define UPLINK_TLS 0
+  #endif
+  #if UPLINK_TLS && !defined(UPLINK_CA_CERT)
+    #error "UPLINK_TLS needs the broker's CA certificate as UPLINK_CA_CERT in codes/secrets.h"
+  #endif
+  #if UPLINK_TLS && !defined(UPLINK_BROKER_PORT)
+    #define UPLINK_BROKER_PORT   8883
+  #endif
+  #define BOARD_UPLINK_TLS       UPLINK_TLS
+  #define BOARD_HAS_IGNITION     1
+  #define BOARD_SAMPLE_PERIOD_MS 1000   // Sampling window while driving
+#elif SMARTTRACK_BOARD == BOARD_WOKWI
+  #define BOARD_HAS_TEMP_SENSOR  1
+  #define BOARD_HAS_GPS          0
+  #define BOARD_HAS_GSM          0
+  #define BOARD_HAS_LCD          1
+  #define BOARD_HAS_WIFI         1
+  #define BOARD_WIFI_SSID        "Wokwi-GUEST"   // Wokwi's simulated access point
+  #define BOARD_WIFI_PASSWORD    ""
+  // Wokwi-GUEST reaches the internet, so batches go to a public test broker
+  #ifndef UPLINK_BROKER_HOST
+    #define UPLINK_BROKER_HOST   "test.mosquitto.org"
+  #endif
+  #ifndef UPLINK_DEVICE_ID
+    #define UPLINK_DEVICE_ID     "smarttrack-wokwi"
+  #endif
+  #define BOARD_UPLINK_TLS       0
+  #define BOARD_HAS_IGNITION     1      // Slide switch on GPIO27
+  #define BOARD_SAMPLE_PERIOD_MS 5000   // Update every cycle (5 seconds)
+#elif SMARTTRACK_BOARD == BOARD_HOST
+  #define BOARD_HAS_TEMP_SENSOR  0
+  #define BOARD_HAS_GPS          0
+  #define BOARD_HAS_GSM          0
+  #define BOARD_HAS_LCD          0
+  #define BOARD_HAS_WIFI         0
+  #define BOARD_UPLINK_TLS       0
+  #define BOARD_HAS_IGNITION     0
+  #define BOARD_SAMPLE_PERIOD_MS 1000
+#else
+  #error "Unknown SMARTTRACK_BOARD"
+#endif
+
+struct BoardProfile {
+  static constexpr bool hasTempSensor = BOARD_HAS_TEMP_SENSOR;
+  static constexpr bool hasGps = BOARD_HAS_GPS;
+  static constexpr bool hasGsm = BOARD_HAS_GSM;
+  static constexpr bool hasLcd = BOARD_HAS_LCD;
+  static constexpr bool hasWifi = BOARD_HAS_WIFI;
+  static constexpr bool hasIgnition = BOARD_HAS_IGNITION;
+  static constexpr unsigned long samplePeriodMs = BOARD_SAMPLE_PERIOD_MS;
+};
+
+#endif
@@ -0,0 +1,192 @@
+#ifndef DRIVER_BEHAVIOR_H
+#define DRIVER_BEHAVIOR_H
+
+// Streaming driver behaviour analysis.
+// Consumes one speed/throttle/RPM sample per loop() pass and keeps per-trip
+// counters in a fixed-size struct: no history buffer, no heap, so it can run
+// at sensor rate on the ESP32. The same header is used by the host batch
+// scorer (backend/DriverScoring.cpp) so thresholds and scoring stay in sync.
+
+#include <stdint.h>
+
+// Driver behaviour thresholds
+#define HARSH_ACCEL_KMH_PER_S   8       // Speed gain per second counted as harsh acceleration
+#define HARSH_BRAKE_KMH_PER_S   10      // Speed loss per second counted as harsh braking
+#define OVER_REV_RPM            4000    // RPM above which the engine is over-revving
+#define OVER_REV_MIN_MS         2000    // Over-rev must persist this long to count
+#define IDLE_RPM_MIN            400     // Engine considered running above this RPM
+#define IDLE_THROTTLE_MAX       5       // Throttle (%) below which the engine is idling
+#define EXCESSIVE_IDLE_MS       60000   // Idling longer than 1 minute is excessive
+#define SPEED_LIMIT_KMH         80      // Speeding threshold
+#define SPEEDING_MIN_MS         3000    // Speeding must persist this long to count
+#define MAX_SAMPLE_GAP_MS       30000   // Larger gaps are not used for rate checks
+
+// Event flags returned by DriverBehavior::update() on the cycle an episode starts
+#define DRIVER_EVENT_HARSH_ACCEL  0x01
+#define DRIVER_EVENT_HARSH_BRAKE  0x02
+#define DRIVER_EVENT_OVER_REV     0x04
+#define DRIVER_EVENT_IDLING       0x08
+#define DRIVER_EVENT_SPEEDING     0x10
+
+// Per-trip counters, updated incrementally
+struct DriverTripStats {
+  uint32_t durationMs;
+  uint32_t drivingMs;        // Time with speed > 0
+  uint32_t distanceM;
+  uint32_t idleMs;
+  uint32_t overRevMs;
+  uint32_t speedingMs;
+  uint32_t harshAccelCount;
+  uint32_t harshBrakeCount;
+  uint32_t overRevCount;
+  uint32_t idleCount;
+  uint32_t speedingCount;
+};
+
+// Trip score from 0 (worst) to 100 (best).
+// Penalty points are normalised per 10 km so long trips are not punished for length.
+inline uint8_t driverScore(const DriverTripStats& s) {
+  uint64_t penalty = 3ULL * s.harshAccelCount
+                   + 4ULL * s.harshBrakeCount
+                   + 2ULL * s.overRevCount
+                   + 2ULL * s.idleCount
+                   + 5ULL * s.speedingCount;
+
+  uint32_t tenKm = s.distanceM / 10000;
+  if (tenKm < 1) tenKm = 1;
+
+  uint64_t perTenKm = penalty / tenKm;
+  if (perTenKm >= 100) return 0;
+  return (uint8_t)(100 - perTenKm);
+}
+
+class DriverBehavior {
+public:
+  DriverBehavior() {
+    startTrip();
+  }
+
+  // Reset all counters, e.g. on ignition on
+  void startTrip() {
+    stats = DriverTripStats();
+    primed = false;
+    lastMs = 0;
+    lastSpeed = 0;
+    distanceRemainder = 0;
+    harshAccelActive = false;
+    harshBrakeActive = false;
+    overRev = Episode();
+    idling = Episode();
+    speeding = Episode();
+  }
+
+  // Feed one sample. Returns DRIVER_EVENT_* flags for episodes that started this cycle.
+  uint8_t update(unsigned long nowMs, int speedKmh, int throttlePct, int rpm) {
+    uint8_t events = 0;
+
+    if (!primed) {
+      primed = true;
+      lastMs = nowMs;
+      lastSpeed = speedKmh;
+      return 0;
+    }
+
+    uint32_t dtMs = (uint32_t)(nowMs - lastMs); // Wrap-safe
+    lastMs = nowMs;
+    stats.durationMs += dtMs;
+    if (speedKmh > 0) stats.drivingMs += dtMs;
+
+    // Distance in metres: km/h * ms / 3600, remainder carried to the next sample
+    distanceRemainder += (uint32_t)speedKmh * dtMs;
+    stats.distanceM += distanceRemainder / 3600;
+    distanceRemainder %= 3600;
+
+    // Harsh acceleration and braking from the speed slope
+    bool accel = false;
+    bool brake = false;
+    if (dtMs > 0 && dtMs <= MAX_SAMPLE_GAP_MS) {
+      long dv = (long)speedKmh - lastSpeed;
+      accel = dv * 1000 > (long)HARSH_ACCEL_KMH_PER_S * (long)dtMs;
+      brake = -dv * 1000 > (long)HARSH_BRAKE_KMH_PER_S * (long)dtMs;
+    }
+    if (accel && !harshAccelActive) {
+      stats.harshAccelCount++;
+      events |= DRIVER_EVENT_HARSH_ACCEL;
+    }
+    if (brake && !harshBrakeActive) {
+      stats.harshBrakeCount++;
+      events |= DRIVER_EVENT_HARSH_BRAKE;
+    }
+    harshAccelActive = accel;
+    harshBrakeActive = brake;
+    lastSpeed = speedKmh;
+
+    // Sustained episodes
+    bool isOverRev = rpm > OVER_REV_RPM;
+    bool isIdle = speedKmh == 0 && rpm >= IDLE_RPM_MIN && throttlePct < IDLE_THROTTLE_MAX;
+    bool isSpeeding = speedKmh > SPEED_LIMIT_KMH;
+
+    if (isOverRev) stats.overRevMs += dtMs;
+    if (isIdle) stats.idleMs += dtMs;
+    if (isSpeeding) stats.speedingMs += dtMs;
+
+    if (trackEpisode(overRev, isOverRev, dtMs, OVER_REV_MIN_MS)) {
+      stats.overRevCount++;
+      events |= DRIVER_EVENT_OVER_REV;
+    }
+    if (trackEpisode(idling, isIdle, dtMs, EXCESSIVE_IDLE_MS)) {
+      stats.idleCount++;
+      events |= DRIVER_EVENT_IDLING;
+    }
+    if (trackEpisode(speeding, isSpeeding, dtMs, SPEEDING_MIN_MS)) {
+      stats.speedingCount++;
+      events |= DRIVER_EVENT_SPEEDING;
+    }
+
+    return events;
+  }
+
+  const DriverTripStats& trip() const {
+    return stats;
+  }
+
+  uint8_t score() const {
+    return driverScore(stats);
+  }
+
+private:
+  // A condition that only counts once it has held for a minimum time
+  struct Episode {
+    uint32_t activeMs;
+    bool counted;
+    Episode() : activeMs(0), counted(false) {}
+  };
+
+  // Returns true on the sample where the episode first reaches minMs
+  static bool trackEpisode(Episode& e, bool condition, uint32_t dtMs, uint32_t minMs) {
+    if (!condition) {
+      e.activeMs = 0;
+      e.counted = false;
+      return false;
+    }
+    e.activeMs += dtMs;
+    if (!e.counted && e.activeMs >= minMs) {
+      e.counted = true;
+      return true;
+    }
+    return false;
+  }
+
+  DriverTripStats stats;
+  bool primed;
+  unsigned long lastMs;
+  int lastSpeed;
+  uint32_t distanceRemainder;
+  bool harshAccelActive;
+  bool harshBrakeActive;
+  Episode overRev;
+  Episode idling;
+  Episode speeding;
+};
+
+#endif
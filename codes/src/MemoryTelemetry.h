@@ -0,0 +1,113 @@
+#ifndef MEMORY_TELEMETRY_H
+#define MEMORY_TELEMETRY_H
+
+// Heap and stack telemetry.
+// Samples free heap, largest free block, fragmentation and per-task stack
+// high-water marks every MEMORY_SAMPLE_INTERVAL_MS, and keeps the lowest
+// values seen since boot so slow leaks show up long before a reboot.
+// On non-ESP32 builds every reading is zero.
+
+#include <Arduino.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+#define MEMORY_SAMPLE_INTERVAL_MS  60000   // Sample once a minute
+#define MEMORY_MAX_TASKS           4       // Tasks whose stacks are tracked
+
+struct MemorySample {
+  uint32_t freeHeap;
+  uint32_t largestFreeBlock;
+  uint32_t minFreeHeap;         // Lowest free heap since boot
+  uint8_t fragmentationPct;     // 100 * (1 - largest block / free heap)
+  uint8_t taskCount;
+  uint32_t stackHighWater[MEMORY_MAX_TASKS];  // Bytes of stack never used, per task
+};
+
+class MemoryTelemetry {
+public:
+  MemoryTelemetry() : taskCount(0), lastSampleMs(0), sampled(false) {
+    current = MemorySample();
+  }
+
+  // Track the calling task (the Arduino loop task when called from setup())
+  void begin() {
+#if defined(ARDUINO_ARCH_ESP32)
+    registerTask(xTaskGetCurrentTaskHandle(), "loop");
+#endif
+    takeSample();
+  }
+
+#if defined(ARDUINO_ARCH_ESP32)
+  // Track another task's stack, e.g. a modem or uplink task
+  bool registerTask(TaskHandle_t task, const char* name) {
+    if (taskCount >= MEMORY_MAX_TASKS) return false;
+    tasks[taskCount] = task;
+    taskNames[taskCount] = name;
+    taskCount++;
+    return true;
+  }
+#endif
+
+  // Sample when the interval has elapsed. Returns true if a new sample was taken.
+  bool sample(unsigned long nowMs) {
+    if (sampled && nowMs - lastSampleMs < MEMORY_SAMPLE_INTERVAL_MS) return false;
+    lastSampleMs = nowMs;
+    takeSample();
+    return true;
+  }
+
+  const MemorySample& latest() const {
+    return current;
+  }
+
+  // One-line report for the serial console
+  void printReport(Print& out) const {
+    out.print("MEM free=");
+    out.print(current.freeHeap);
+    out.print(" largest=");
+    out.print(current.largestFreeBlock);
+    out.print(" frag=");
+    out.print(current.fragmentationPct);
+    out.print("% min=");
+    out.print(current.minFreeHeap);
+    for (uint8_t i = 0; i < current.taskCount; i++) {
+      out.print(" stack[");
+      out.print(taskNames[i]);
+      out.print("]=");
+      out.print(current.stackHighWater[i]);
+    }
+    out.println();
+  }
+
+private:
+  void takeSample() {
+    sampled = true;
+#if defined(ARDUINO_ARCH_ESP32)
+    current.freeHeap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    current.largestFreeBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    current.minFreeHeap = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    // ESP-IDF reports stack high-water marks in bytes
+    current.taskCount = taskCount;
+    for (uint8_t i = 0; i < taskCount; i++) {
+      current.stackHighWater[i] = uxTaskGetStackHighWaterMark(tasks[i]);
+    }
+#endif
+    current.fragmentationPct = current.freeHeap == 0 ? 0
+      : (uint8_t)(100 - (uint64_t)current.largestFreeBlock * 100 / current.freeHeap);
+  }
+
+  MemorySample current;
+#if defined(ARDUINO_ARCH_ESP32)
+  TaskHandle_t tasks[MEMORY_MAX_TASKS];
+#endif
+  const char* taskNames[MEMORY_MAX_TASKS];
+  uint8_t taskCount;
+  unsigned long lastSampleMs;
+  bool sampled;
+};
+
+#endif
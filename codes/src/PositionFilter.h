@@ -0,0 +1,247 @@
+#ifndef POSITION_FILTER_H
+#define POSITION_FILTER_H
+
+// GPS/odometry position fusion in fixed point.
+// Dead-reckons from vehicle speed and heading between GPS fixes and blends
+// fixes in with a scalar Kalman gain, so the position stays continuous
+// through tunnels and garages and carries an error radius. Integer-only:
+// positions are 1e-7 degrees, distances millimetres, variances m^2 in Q8.
+
+#include <stdint.h>
+
+#define POS_GPS_SIGMA_M          5      // NEO-6M horizontal accuracy (1 sigma)
+#ifndef POS_DR_DRIFT_PCT
+#define POS_DR_DRIFT_PCT         10     // Error radius growth dead-reckoning on a known heading, % of distance
+#endif
+#define POS_MAX_VARIANCE_M2      1000000 // Cap, about 2 km error radius
+#define POS_GATE_SIGMAS          5      // Fixes further out than this are treated as outliers
+#define POS_MAX_REJECTS          3      // Consecutive outliers before the filter re-anchors on GPS
+#define POS_RECENTER_MM          10000000 // Fold dead-reckoned offsets past 10 km into the origin
+
+// Quarter-wave sine table, Q15, 64 steps from 0 to 90 degrees
+static const int16_t POS_SIN_TABLE[65] = {
+  0, 804, 1608, 2410, 3212, 4011, 4808, 5602, 6393,
+  7179, 7962, 8739, 9512, 10278, 11039, 11793, 12539, 13279,
+  14010, 14732, 15446, 16151, 16846, 17530, 18204, 18868, 19519,
+  20159, 20787, 21403, 22005, 22594, 23170, 23731, 24279, 24811,
+  25329, 25832, 26319, 26790, 27245, 27683, 28105, 28510, 28898,
+  29268, 29621, 29956, 30273, 30571, 30852, 31113, 31356, 31580,
+  31785, 31971, 32137, 32285, 32412, 32521, 32609, 32678, 32728,
+  32757, 32767,
+};
+
+// Sine of a binary angle (65536 = 360 degrees), Q15
+inline int32_t posSin(uint16_t angle) {
+  uint16_t quadrant = angle >> 14;
+  uint16_t a = angle & 0x3FFF;
+  if (quadrant & 1) a = 0x4000 - a;       // Mirror in the 2nd and 4th quadrants
+  uint16_t index = a >> 8;
+  int32_t frac = a & 0xFF;
+  int32_t value = POS_SIN_TABLE[index];
+  if (index < 64) value += ((POS_SIN_TABLE[index + 1] - value) * frac) >> 8;
+  return (quadrant & 2) ? -value : value;
+}
+
+inline int32_t posCos(uint16_t angle) {
+  return posSin((uint16_t)(angle + 0x4000));
+}
+
+inline uint32_t posIsqrt(uint32_t x) {
+  uint32_t result = 0;
+  uint32_t bit = 1UL << 30;
+  while (bit > x) bit >>= 2;
+  while (bit) {
+    if (x >= result + bit) {
+      x -= result + bit;
+      result = (result >> 1) + bit;
+    } else {
+      result >>= 1;
+    }
+    bit >>= 2;
+  }
+  return result;
+}
+
+// Filter state small enough to keep in RTC memory through deep sleep
+struct PositionState {
+  int32_t latE7;
+  int32_t lonE7;
+  uint32_t varianceQ8;
+  bool hasFix;
+  bool valid;
+};
+
+class PositionFilter {
+public:
+  PositionFilter() {
+    reset(0, 0, POS_MAX_VARIANCE_M2);
+  }
+
+  // Start from a known position with the given variance (m^2)
+  void reset(int32_t latE7, int32_t lonE7, uint32_t varianceM2) {
+    setOrigin(latE7, lonE7);
+    varianceQ8 = clampVariance((uint64_t)varianceM2 << 8);
+    headingKnown = false;
+    heading = 0;
+    rejects = 0;
+    hasFix = false;
+  }
+
+  // Heading in hundredths of a degree, clockwise from north (as reported by GPS)
+  void setHeading(int32_t centiDegrees) {
+    centiDegrees %= 36000;
+    if (centiDegrees < 0) centiDegrees += 36000;
+    heading = (uint16_t)(((uint32_t)centiDegrees << 16) / 36000);
+    headingKnown = true;
+  }
+
+  // Dead-reckon forward by dtMs at the vehicle's speed. The error radius
+  // grows with the distance covered: by POS_DR_DRIFT_PCT of it along a known
+  // heading, by all of it without one, in which case the estimate stays put.
+  void predict(uint32_t dtMs, int speedKmh) {
+    if (speedKmh <= 0 || dtMs == 0) return;
+
+    // km/h * ms / 3.6 = mm
+    int64_t distMm = (int64_t)speedKmh * dtMs * 10 / 36;
+    if (distMm > 4000000) distMm = 4000000;  // Past the variance cap anyway
+    uint64_t growthQ4 = (uint64_t)distMm * 16 / 1000 / 2;  // Sigma, half the radius
+    if (headingKnown) {
+      xMm += (int32_t)((distMm * posSin(heading)) >> 15);  // East
+      yMm += (int32_t)((distMm * posCos(heading)) >> 15);  // North
+      growthQ4 = growthQ4 * POS_DR_DRIFT_PCT / 100;
+      // Without fixes the offset would grow until it overflowed, and the
+      // flat-earth frame is only good near its origin
+      if (xMm > POS_RECENTER_MM || xMm < -POS_RECENTER_MM || yMm > POS_RECENTER_MM || yMm < -POS_RECENTER_MM) {
+        setOrigin(latE7Estimate(), lonE7Estimate());
+      }
+    }
+    uint64_t sigmaQ4 = posIsqrt(varianceQ8) + growthQ4;
+    varianceQ8 = clampVariance(sigmaQ4 * sigmaQ4);
+  }
+
+  // Blend in a GPS fix. Returns false if the fix was rejected as an outlier.
+  bool updateGps(int32_t latE7, int32_t lonE7) {
+    if (!hasFix) {
+      // First fix: anchor on it
+      reset(latE7, lonE7, (uint32_t)POS_GPS_SIGMA_M * POS_GPS_SIGMA_M);
+      hasFix = true;
+      return true;
+    }
+
+    int32_t zx = lonToMm(lonE7 - originLonE7);
+    int32_t zy = latToMm(latE7 - originLatE7);
+    int64_t dx = (int64_t)zx - xMm;
+    int64_t dy = (int64_t)zy - yMm;
+
+    const uint64_t rQ8 = ((uint64_t)POS_GPS_SIGMA_M * POS_GPS_SIGMA_M) << 8;
+    uint64_t sQ8 = varianceQ8 + rQ8;
+
+    // Innovation gate: |d|^2 (mm^2) against gate^2 * S (m^2 Q8 -> mm^2)
+    uint64_t d2 = (uint64_t)(dx * dx + dy * dy);
+    uint64_t gate = (uint64_t)POS_GATE_SIGMAS * POS_GATE_SIGMAS * sQ8 * 1000000 >> 8;
+    if (d2 > gate) {
+      if (++rejects < POS_MAX_REJECTS) return false;
+      reset(latE7, lonE7, (uint32_t)POS_GPS_SIGMA_M * POS_GPS_SIGMA_M);
+      hasFix = true;
+      return true;
+    }
+    rejects = 0;
+
+    // Kalman gain K = P / (P + R), Q16
+    uint32_t gain = (uint32_t)(((uint64_t)varianceQ8 << 16) / sQ8);
+    xMm += (int32_t)((dx * gain) >> 16);
+    yMm += (int32_t)((dy * gain) >> 16);
+    varianceQ8 = (uint32_t)(((uint64_t)varianceQ8 * (65536 - gain)) >> 16);
+
+    // Re-centre the local frame on the estimate to keep the flat-earth error small
+    setOrigin(latE7Estimate(), lonE7Estimate());
+    return true;
+  }
+
+  // Stays on the globe: stops at the poles, wraps at the antimeridian
+  int32_t latE7Estimate() const {
+    int64_t lat = (int64_t)originLatE7 + mmToLat(yMm);
+    if (lat > 900000000) lat = 900000000;
+    if (lat < -900000000) lat = -900000000;
+    return (int32_t)lat;
+  }
+
+  int32_t lonE7Estimate() const {
+    int64_t lon = (int64_t)originLonE7 + mmToLon(xMm);
+    if (lon >= 1800000000) lon -= 3600000000LL;
+    if (lon < -1800000000) lon += 3600000000LL;
+    return (int32_t)lon;
+  }
+
+  // About 95% of true positions lie within this radius (2 sigma), metres
+  uint32_t errorRadiusM() const {
+    return 2 * posIsqrt(varianceQ8) / 16;
+  }
+
+  bool everFixed() const {
+    return hasFix;
+  }
+
+  void save(PositionState& s) const {
+    s.latE7 = latE7Estimate();
+    s.lonE7 = lonE7Estimate();
+    s.varianceQ8 = varianceQ8;
+    s.hasFix = hasFix;
+    s.valid = true;
+  }
+
+  // Continue from a saved estimate. The heading is dropped: the vehicle may
+  // leave in any direction, so the estimate holds until GPS reports a course.
+  void restore(const PositionState& s) {
+    reset(s.latE7, s.lonE7, 0);
+    varianceQ8 = clampVariance(s.varianceQ8);
+    hasFix = s.hasFix;
+  }
+
+private:
+  void setOrigin(int32_t latE7, int32_t lonE7) {
+    originLatE7 = latE7;
+    originLonE7 = lonE7;
+    xMm = 0;
+    yMm = 0;
+    // Binary angle of the latitude: degrees * 65536 / 360
+    uint16_t latAngle = (uint16_t)((int64_t)latE7 * 65536 / 3600000000LL);
+    cosLatQ15 = posCos(latAngle);
+    if (cosLatQ15 < 1) cosLatQ15 = 1;
+  }
+
+  // 1e-7 degree of latitude is 11.054 mm; of longitude 11.132 mm * cos(latitude)
+  static int32_t latToMm(int32_t dLatE7) {
+    return (int32_t)((int64_t)dLatE7 * 11054 / 1000);
+  }
+
+  int32_t lonToMm(int32_t dLonE7) const {
+    return (int32_t)((int64_t)dLonE7 * 11132 * cosLatQ15 / (1000LL << 15));
+  }
+
+  static int32_t mmToLat(int32_t mm) {
+    return (int32_t)((int64_t)mm * 1000 / 11054);
+  }
+
+  int32_t mmToLon(int32_t mm) const {
+    return (int32_t)(((int64_t)mm * (1000LL << 15)) / ((int64_t)11132 * cosLatQ15));
+  }
+
+  static uint32_t clampVariance(uint64_t vQ8) {
+    const uint64_t maxQ8 = (uint64_t)POS_MAX_VARIANCE_M2 << 8;
+    return (uint32_t)(vQ8 > maxQ8 ? maxQ8 : vQ8);
+  }
+
+  int32_t originLatE7;
+  int32_t originLonE7;
+  int32_t cosLatQ15;
+  int32_t xMm;
+  int32_t yMm;
+  uint32_t varianceQ8;
+  uint16_t heading;
+  bool headingKnown;
+  uint8_t rejects;
+  bool hasFix;
+};
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef POWER_POLICY_H
+#define POWER_POLICY_H
+
+// Duty-cycling policy and energy accounting, free of hardware calls so the
+// same state machine runs on the ESP32 (PowerManager.h) and in the host
+// simulation (backend/power_sim.cpp).
+//
+//   DRIVING  moving or ignition on: sample every drivingPeriodMs, light sleep between, GPS on
+//   PARKED   stopped: sample every POWER_PARKED_PERIOD_MS, light sleep between, GPS off
+//   DEEP     parked for POWER_DEEP_AFTER_MS: deep sleep, check in every POWER_CHECKIN_MS
+//
+// How a board sleeps between windows is up to PowerManager: boards with WiFi
+// keep the uplink associated in modem sleep and let the idle task enter
+// light sleep on its own (counted as wifiSleepMs); the others light-sleep
+// with the radio off (lightSleepMs).
+
+#include <stdint.h>
+
+#define POWER_PARKED_PERIOD_MS  10000       // Sampling period while parked
+#define POWER_DEEP_AFTER_MS     1800000UL   // Deep sleep after 30 minutes parked
+#define POWER_CHECKIN_MS        900000UL    // Deep-sleep check-in every 15 minutes
+
+// Estimated ESP32 module current in each state (uA). Peripherals are not included.
+#define POWER_AWAKE_UA          50000       // CPU on, WiFi in modem sleep
+#define POWER_LIGHT_SLEEP_UA    800         // Radio off
+#define POWER_WIFI_SLEEP_UA     2000        // Auto light sleep, WiFi associated and waking for DTIM 3 beacons
+#define POWER_MODEM_SLEEP_UA    20000       // Idle at 80 MHz, WiFi in modem sleep (no auto light sleep)
+#define POWER_DEEP_SLEEP_UA     150
+
+#define POWER_DRIVING  0
+#define POWER_PARKED   1
+#define POWER_DEEP     2
+
+struct PowerDecision {
+  uint8_t mode;
+  uint32_t sleepMs;       // Time to sleep before the next sampling window
+  bool deep;              // Deep sleep (the device restarts on wake)
+  bool gpsPowered;        // The GPS receiver is only powered while driving
+};
+
+// Time spent in each power state since first boot
+struct EnergyCounters {
+  uint64_t awakeMs;
+  uint64_t lightSleepMs;
+  uint64_t wifiSleepMs;     // Between windows with WiFi kept up, in auto light sleep
+  uint64_t modemSleepMs;    // Between windows with WiFi kept up, CPU idle
+  uint64_t deepSleepMs;
+  uint32_t wakeups;
+};
+
+class PowerPolicy {
+public:
+  explicit PowerPolicy(uint32_t drivingPeriodMs) : drivingPeriodMs(drivingPeriodMs) {
+    begin(0, false);
+  }
+
+  // resumedParked: woken from a deep-sleep check-in, so the vehicle was already parked
+  void begin(uint32_t nowMs, bool resumedParked) {
+    parkedDeep = resumedParked;
+    lastActiveMs = nowMs;
+    mode_ = resumedParked ? POWER_DEEP : POWER_DRIVING;
+  }
+
+  // Decide how to spend the rest of the window. workMs is how long this window was awake.
+  PowerDecision decide(uint32_t nowMs, int speedKmh, bool ignitionOn, uint32_t workMs) {
+    PowerDecision d;
+    if (speedKmh > 0 || ignitionOn) {
+      lastActiveMs = nowMs;
+      parkedDeep = false;
+      mode_ = POWER_DRIVING;
+    } else if (parkedDeep || nowMs - lastActiveMs >= POWER_DEEP_AFTER_MS) {
+      parkedDeep = true;
+      mode_ = POWER_DEEP;
+    } else {
+      mode_ = POWER_PARKED;
+    }
+
+    d.mode = mode_;
+    d.deep = mode_ == POWER_DEEP;
+    d.gpsPowered = mode_ == POWER_DRIVING;
+    uint32_t period = mode_ == POWER_DRIVING ? drivingPeriodMs
+                    : mode_ == POWER_PARKED ? POWER_PARKED_PERIOD_MS : POWER_CHECKIN_MS;
+    d.sleepMs = d.deep ? period : (workMs < period ? period - workMs : 0);
+    return d;
+  }
+
+  uint8_t mode() const {
+    return mode_;
+  }
+
+  // Adaptive sampling moves the next driving window earlier or later
+  void setDrivingPeriod(uint32_t periodMs) {
+    drivingPeriodMs = periodMs;
+  }
+
+private:
+  uint32_t drivingPeriodMs;
+  uint32_t lastActiveMs;
+  bool parkedDeep;
+  uint8_t mode_;
+};
+
+// Average current over the counted time, uA
+inline uint32_t powerAverageMicroAmps(const EnergyCounters& c) {
+  uint64_t total = c.awakeMs + c.lightSleepMs + c.wifiSleepMs + c.modemSleepMs + c.deepSleepMs;
+  if (total == 0) return 0;
+  uint64_t charge = c.awakeMs * POWER_AWAKE_UA
+                  + c.lightSleepMs * POWER_LIGHT_SLEEP_UA
+                  + c.wifiSleepMs * POWER_WIFI_SLEEP_UA
+                  + c.modemSleepMs * POWER_MODEM_SLEEP_UA
+                  + c.deepSleepMs * POWER_DEEP_SLEEP_UA;
+  return (uint32_t)(charge / total);
+}
+
+#endif
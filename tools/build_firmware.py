@@ -0,0 +1,74 @@
+"""Build a firmware target with arduino-cli and fail if it is over its size budget.
+
+    python tools/build_firmware.py esp32_field
+    python tools/build_firmware.py wokwi --fqbn esp32:esp32:esp32 --build-dir build/wokwi
+
+The entry point and codes/src are staged as a sketch under the build
+directory (arduino-cli wants <name>/<name>.ino), then compiled with
+tools/size_report.py added as a post-objcopy hook. arduino-cli stops with
+an error when a hook fails, so a flash, DRAM, IRAM or RTC overrun, or a
+symbol over its RAM budget, fails the build. Pass --print to show the
+compile command without running it.
+"""
+
+import argparse
+import os
+import shlex
+import shutil
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# Budget entry in size_budgets.json -> (entry point, sketch name)
+TARGETS = {
+    "esp32_field": ("codes/Arduino_Code.cpp", "Arduino_Code"),
+    "wokwi": ("codes/Wokwi_code.cpp", "Wokwi_code"),
+}
+
+
+def stage_sketch(entry, name, build_dir):
+    sketch = os.path.join(build_dir, "sketch", name)
+    if os.path.isdir(sketch):
+        shutil.rmtree(sketch)
+    shutil.copytree(os.path.join(ROOT, "codes", "src"), os.path.join(sketch, "src"))
+    shutil.copyfile(os.path.join(ROOT, entry), os.path.join(sketch, name + ".ino"))
+    secrets = os.path.join(ROOT, "codes", "secrets.h")
+    if os.path.exists(secrets):
+        shutil.copyfile(secrets, os.path.join(sketch, "secrets.h"))
+    return sketch
+
+
+def size_hook(target):
+    # Expanded by arduino-cli: the toolchain's own objdump/nm read the ELF
+    report = os.path.join(ROOT, "tools", "size_report.py")
+    return ("recipe.hooks.objcopy.postobjcopy.90.pattern="
+            "\"%s\" \"%s\" \"{build.path}/{build.project_name}.elf\" --target %s"
+            " --objdump \"{compiler.path}{compiler.prefix}objdump\""
+            " --nm \"{compiler.path}{compiler.prefix}nm\"" % (sys.executable, report, target))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("target", choices=sorted(TARGETS))
+    parser.add_argument("--fqbn", default="esp32:esp32:esp32")
+    parser.add_argument("--build-dir", help="default: build/<target>")
+    parser.add_argument("--arduino-cli", default="arduino-cli")
+    parser.add_argument("--print", action="store_true", help="show the command instead of running it")
+    args = parser.parse_args()
+
+    entry, name = TARGETS[args.target]
+    build_dir = os.path.abspath(args.build_dir or os.path.join(ROOT, "build", args.target))
+    sketch = stage_sketch(entry, name, build_dir)
+    command = [args.arduino_cli, "compile", "--fqbn", args.fqbn,
+               "--build-path", os.path.join(build_dir, "out"),
+               "--build-property", size_hook(args.target), sketch]
+
+    if args.print:
+        print(" ".join(shlex.quote(part) for part in command))
+        return 0
+    return subprocess.call(command)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,146 @@
+"""Per-symbol RAM/flash report for a firmware ELF, checked against size budgets.
+
+    python tools/size_report.py build/Arduino_Code.ino.elf --target esp32_field \
+        --objdump xtensa-esp32-elf-objdump --nm xtensa-esp32-elf-nm
+
+Symbols are classified by the section they live in, and sections by where
+they are loaded (objdump -h): a section with LOAD contents occupies flash,
+and one whose address falls in the chip's DRAM, IRAM or RTC memory occupies
+that RAM. So .data counts in flash and DRAM, IRAM code in flash and IRAM,
+.bss in DRAM only. Exits with status 1 when a total or a single symbol is
+over the target's budget in tools/size_budgets.json. tools/build_firmware.py
+runs it as a post-build hook, so an overrun fails the build.
+"""
+
+import argparse
+import bisect
+import json
+import os
+import subprocess
+import sys
+
+# Internal RAM regions by chip, as [start, end) virtual addresses.
+# Anything else (flash-mapped DROM/IROM) occupies only flash.
+MEMORY_MAPS = {
+    "esp32": [
+        ("dram", 0x3FFAE000, 0x40000000),
+        ("iram", 0x40070000, 0x400A0000),
+        ("rtc", 0x3FF80000, 0x3FF82000),    # RTC fast memory, data bus
+        ("rtc", 0x400C0000, 0x400C2000),    # RTC fast memory, instruction bus
+        ("rtc", 0x50000000, 0x50002000),    # RTC slow memory
+    ],
+}
+RAM_REGIONS = ("dram", "iram", "rtc")
+
+
+def read_sections(objdump, elf, memory_map):
+    """Return [(start, end, name, region, in_flash)] for allocated sections, by address."""
+    out = subprocess.run([objdump, "-h", "-w", elf], check=True, capture_output=True, text=True).stdout
+    sections = []
+    for line in out.splitlines():
+        parts = line.split(None, 7)
+        # Idx Name Size VMA LMA File-off Algn Flags
+        if len(parts) < 8 or not parts[0].isdigit():
+            continue
+        name, size, vma, flags = parts[1], int(parts[2], 16), int(parts[3], 16), parts[7]
+        if "ALLOC" not in flags or size == 0:
+            continue
+        region = "flash"
+        for region_name, start, end in memory_map:
+            if start <= vma < end:
+                region = region_name
+                break
+        sections.append((vma, vma + size, name, region, "LOAD" in flags))
+    sections.sort()
+    return sections
+
+
+def section_at(sections, starts, address):
+    i = bisect.bisect_right(starts, address) - 1
+    if i >= 0 and address < sections[i][1]:
+        return sections[i]
+    return None
+
+
+def read_symbols(nm, elf):
+    out = subprocess.run([nm, "-S", "--size-sort", "--demangle", elf],
+                         check=True, capture_output=True, text=True).stdout
+    symbols = []
+    for line in out.splitlines():
+        parts = line.split(None, 3)
+        if len(parts) < 4:
+            continue
+        address, size, _, name = parts
+        symbols.append((name, int(address, 16), int(size, 16)))
+    return symbols
+
+
+def summarise(sections, symbols):
+    totals = {"flash": 0, "dram": 0, "iram": 0, "rtc": 0}
+    for start, end, _, region, in_flash in sections:
+        if in_flash:
+            totals["flash"] += end - start
+        if region in RAM_REGIONS:
+            totals[region] += end - start
+
+    starts = [s[0] for s in sections]
+    rows = []
+    for name, address, size in symbols:
+        section = section_at(sections, starts, address)
+        if section is None:
+            continue
+        _, _, section_name, region, in_flash = section
+        ram = size if region in RAM_REGIONS else 0
+        flash = size if in_flash else 0
+        if ram or flash:
+            rows.append((name, section_name, region, ram, flash))
+    return totals, rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf")
+    parser.add_argument("--target", required=True, help="budget entry, e.g. esp32_field or wokwi")
+    parser.add_argument("--objdump", default="objdump", help="objdump for the target toolchain")
+    parser.add_argument("--nm", default="nm", help="nm for the target toolchain")
+    parser.add_argument("--budgets", default=os.path.join(os.path.dirname(__file__), "size_budgets.json"))
+    parser.add_argument("--top", type=int, default=20, help="largest symbols to list")
+    args = parser.parse_args()
+
+    with open(args.budgets) as f:
+        budgets = json.load(f)
+    if args.target not in budgets:
+        sys.exit("no budget for target %r in %s" % (args.target, args.budgets))
+    budget = budgets[args.target]
+    if budget["chip"] not in MEMORY_MAPS:
+        sys.exit("no memory map for chip %r" % budget["chip"])
+
+    sections = read_sections(args.objdump, args.elf, MEMORY_MAPS[budget["chip"]])
+    totals, rows = summarise(sections, read_symbols(args.nm, args.elf))
+
+    print("%-52s %-16s %8s %8s" % ("symbol", "section", "ram", "flash"))
+    for name, section, region, ram, flash in sorted(rows, key=lambda r: max(r[3], r[4]), reverse=True)[:args.top]:
+        print("%-52s %-16s %8d %8d" % (name[:52], section[:16], ram, flash))
+    print()
+
+    failures = []
+    for region, key in (("flash", "flash_bytes"), ("dram", "ram_bytes"), ("iram", "iram_bytes"), ("rtc", "rtc_bytes")):
+        limit = budget.get(key)
+        if limit is None:
+            print("%-6s %d bytes" % (region + ":", totals[region]))
+            continue
+        print("%-6s %d / %d bytes (%.1f%%)" % (region + ":", totals[region], limit, 100.0 * totals[region] / limit))
+        if totals[region] > limit:
+            failures.append("%s %d exceeds budget %d" % (region, totals[region], limit))
+    for name, section, region, ram, _ in rows:
+        if ram > budget["symbol_ram_bytes"]:
+            failures.append("symbol %s uses %d bytes of %s in %s (budget %d)"
+                            % (name, ram, region, section, budget["symbol_ram_bytes"]))
+
+    for failure in failures:
+        print("SIZE BUDGET: " + failure, file=sys.stderr)
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == "__main__":
+    main()
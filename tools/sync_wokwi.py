@@ -0,0 +1,58 @@
+"""Copy the shared firmware headers into the Wokwi project.
+
+    python tools/sync_wokwi.py           # update wokwi_implementation/src
+    python tools/sync_wokwi.py --check   # exit 1 if the copy is stale
+
+The Wokwi web editor and Windows checkouts cannot follow a symlink, so
+wokwi_implementation/src holds a committed copy of codes/src. Edit the
+files under codes/src only, then run this script and commit both.
+"""
+
+import argparse
+import filecmp
+import os
+import shutil
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCE = os.path.join(ROOT, "codes", "src")
+TARGET = os.path.join(ROOT, "wokwi_implementation", "src")
+
+
+def headers(path):
+    if not os.path.isdir(path):
+        return set()
+    return {name for name in os.listdir(path) if name.endswith(".h")}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--check", action="store_true", help="report differences without copying")
+    args = parser.parse_args()
+
+    wanted = headers(SOURCE)
+    present = headers(TARGET)
+    stale = sorted(name for name in wanted
+                   if name not in present or not filecmp.cmp(os.path.join(SOURCE, name),
+                                                             os.path.join(TARGET, name), shallow=False))
+    extra = sorted(present - wanted)
+
+    if args.check:
+        for name in stale:
+            print("out of date: wokwi_implementation/src/%s" % name)
+        for name in extra:
+            print("not in codes/src: wokwi_implementation/src/%s" % name)
+        return 1 if stale or extra else 0
+
+    os.makedirs(TARGET, exist_ok=True)
+    for name in stale:
+        shutil.copyfile(os.path.join(SOURCE, name), os.path.join(TARGET, name))
+        print("copied %s" % name)
+    for name in extra:
+        os.remove(os.path.join(TARGET, name))
+        print("removed %s" % name)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
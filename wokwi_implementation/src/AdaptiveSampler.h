@@ -0,0 +1,287 @@
+#ifndef ADAPTIVE_SAMPLER_H
+#define ADAPTIVE_SAMPLER_H
+
+// Per-signal adaptive sampling rates under a shared cost budget.
+// Each signal's rate rises with its rate of change and with how close it is
+// to its DTC threshold, and backs off gradually once it is stable. A token
+// bucket caps the total sampling cost; a signal past its threshold may
+// borrow ahead of the budget so faults are always followed closely.
+// Hardware-free, so the replay benchmark (backend/sampling_replay.cpp)
+// runs the same controller. Values are integers in the signal's own units,
+// e.g. hundredths of a degree or volt.
+
+#include <stdint.h>
+
+#define SAMPLER_MAX_SIGNALS   4
+#define SAMPLER_URGENCY_MAX   256     // Urgency is Q8: 0 stable .. 256 at or past threshold
+#define SAMPLER_BACKOFF_NUM   3       // Period grows by at most 3/2 per sample when calming down
+#define SAMPLER_BACKOFF_DEN   2
+#define SAMPLER_BURST_MS      2000    // Budget that may be saved up, in milliseconds of refill
+#define SAMPLER_EARLY_DIV     4       // A signal due within a quarter period joins a window already taken
+
+struct SignalConfig {
+  uint32_t minPeriodMs;   // Fastest rate, used at full urgency
+  uint32_t maxPeriodMs;   // Slowest rate, used when stable and far from threshold
+  uint32_t nearPeriodMs;  // Slowest rate inside nearBand of the threshold
+  int32_t threshold;      // DTC threshold
+  bool alarmBelow;        // True if the fault is below the threshold (low voltage)
+  int32_t nearBand;       // Proximity urgency ramps up inside this distance of the threshold
+  int32_t fastSlope;      // Rate of change (units per second) that counts as full urgency
+  uint16_t cost;          // Budget units per sample
+};
+
+struct SamplerStats {
+  uint32_t samples[SAMPLER_MAX_SIGNALS];
+  uint32_t deferred;      // Samples pushed back because the budget was spent
+  uint32_t spent;         // Budget units used
+};
+
+class AdaptiveSampler {
+public:
+  // Budget shared by all signals: budgetUnits refilled every budgetPeriodMs
+  AdaptiveSampler(uint32_t budgetUnits, uint32_t budgetPeriodMs = 1000)
+    : budgetUnits(budgetUnits), budgetPeriodMs(budgetPeriodMs ? budgetPeriodMs : 1), count(0) {
+    reset(0);
+  }
+
+  // Returns the signal index, or -1 if the table is full
+  int addSignal(const SignalConfig& config) {
+    if (count >= SAMPLER_MAX_SIGNALS) return -1;
+    Signal& s = signals[count];
+    s.config = config;
+    s.primed = false;
+    s.periodMs = config.maxPeriodMs;
+    s.urgency = 0;
+    s.near = false;
+    count++;
+    tokensMilli = budgetDepth();  // Start with a full bucket
+    return count - 1;
+  }
+
+  // Forget all history; every signal is due on the next call to due()
+  void reset(uint32_t nowMs) {
+    for (uint8_t i = 0; i < count; i++) {
+      signals[i].primed = false;
+      signals[i].periodMs = signals[i].config.maxPeriodMs;
+      signals[i].urgency = 0;
+      signals[i].near = false;
+    }
+    lastRefillMs = nowMs;
+    refillRemainder = 0;
+    tokensMilli = budgetDepth();
+    stats = SamplerStats();
+  }
+
+  // Bit mask of signals to read now. Due signals are served most urgent first;
+  // those the budget cannot cover are deferred until it can. Signals nearly
+  // due are read along with them, so one window (and one telemetry frame)
+  // serves both instead of two a moment apart.
+  uint8_t due(uint32_t nowMs) {
+    refill(nowMs);
+
+    uint8_t order[SAMPLER_MAX_SIGNALS];
+    uint8_t n = 0;
+    bool any = false;
+    for (uint8_t i = 0; i < count; i++) {
+      if (isDue(signals[i], nowMs)) any = true;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+      if (!isDue(signals[i], nowMs) && !(any && isDue(signals[i], nowMs + signals[i].periodMs / SAMPLER_EARLY_DIV))) {
+        continue;
+      }
+      uint8_t j = n++;
+      while (j > 0 && signals[order[j - 1]].urgency < signals[i].urgency) {
+        order[j] = order[j - 1];
+        j--;
+      }
+      order[j] = i;
+    }
+
+    uint8_t mask = 0;
+    for (uint8_t k = 0; k < n; k++) {
+      Signal& s = signals[order[k]];
+      int32_t costMilli = (int32_t)s.config.cost * 1000;
+      // In alarm a signal may run the bucket negative, down to one burst of
+      // debt. Once it has gone its slowest period unread (nearPeriodMs near
+      // the threshold, else maxPeriodMs) it is read regardless, so no signal
+      // is ever followed less closely than at its fixed rate.
+      bool overdue = s.primed && nowMs - s.lastMs >= (s.near ? s.config.nearPeriodMs : s.config.maxPeriodMs);
+      int32_t floor = s.urgency >= SAMPLER_URGENCY_MAX ? -(int32_t)budgetDepth() : 0;
+      if (overdue || tokensMilli - costMilli >= floor) {
+        tokensMilli -= costMilli;
+        if (tokensMilli < -(int32_t)budgetDepth()) tokensMilli = -(int32_t)budgetDepth();
+        stats.spent += s.config.cost;
+        stats.samples[order[k]]++;
+        mask |= 1 << order[k];
+      } else {
+        // Retry once the bucket holds enough for this sample
+        uint64_t needMilli = (uint64_t)(costMilli + floor - tokensMilli);
+        uint32_t waitMs = (uint32_t)(needMilli * budgetPeriodMs / (budgetUnits ? budgetUnits * 1000ULL : 1)) + 1;
+        s.nextDueMs = nowMs + waitMs;
+        stats.deferred++;
+      }
+    }
+    return mask;
+  }
+
+  // Spend budget on work that follows the samples, such as sending them
+  void charge(uint32_t nowMs, uint16_t cost) {
+    refill(nowMs);
+    int32_t tokens = tokensMilli - (int32_t)cost * 1000;
+    int32_t floor = -(int32_t)budgetDepth();
+    tokensMilli = tokens < floor ? floor : tokens;
+    stats.spent += cost;
+  }
+
+  // Report a reading for a signal returned by due(); schedules its next sample
+  void record(uint8_t index, uint32_t nowMs, int32_t value) {
+    Signal& s = signals[index];
+    if (s.primed) {
+      uint32_t dtMs = nowMs - s.lastMs;
+      if (dtMs > 0) {
+        int32_t slope = (int32_t)(((int64_t)value - s.lastValue) * 1000 / (int64_t)dtMs);
+        s.slope += (slope - s.slope) / 2;  // Light smoothing of sensor noise
+      }
+    } else {
+      s.primed = true;
+      s.slope = 0;
+    }
+    s.lastValue = value;
+    s.lastMs = nowMs;
+    s.urgency = urgencyOf(s);
+    s.near = isNear(s);
+
+    // Raise the rate at once, lower it gradually
+    uint32_t target = periodFor(s.config, s.urgency);
+    if (s.near && target > s.config.nearPeriodMs) target = s.config.nearPeriodMs;
+    uint32_t relaxed = s.periodMs / SAMPLER_BACKOFF_DEN * SAMPLER_BACKOFF_NUM;
+    s.periodMs = target <= s.periodMs ? target : (target < relaxed ? target : relaxed);
+    s.nextDueMs = nowMs + s.periodMs;
+  }
+
+  // Earliest time any signal is due
+  uint32_t nextDueMs(uint32_t nowMs) const {
+    uint32_t soonest = nowMs + 0x7FFFFFFFUL;
+    for (uint8_t i = 0; i < count; i++) {
+      if (!signals[i].primed) return nowMs;
+      if ((int32_t)(signals[i].nextDueMs - soonest) < 0) soonest = signals[i].nextDueMs;
+    }
+    return count ? soonest : nowMs;
+  }
+
+  uint32_t periodMs(uint8_t index) const {
+    return signals[index].periodMs;
+  }
+
+  uint16_t urgency(uint8_t index) const {
+    return signals[index].urgency;
+  }
+
+  const SamplerStats& statistics() const {
+    return stats;
+  }
+
+private:
+  struct Signal {
+    SignalConfig config;
+    bool primed;
+    int32_t lastValue;
+    uint32_t lastMs;
+    int32_t slope;        // Smoothed units per second
+    uint16_t urgency;
+    bool near;            // Last value within nearBand of the threshold
+    uint32_t periodMs;
+    uint32_t nextDueMs;
+  };
+
+  static bool isDue(const Signal& s, uint32_t nowMs) {
+    return !s.primed || (int32_t)(nowMs - s.nextDueMs) >= 0;
+  }
+
+  static bool isNear(const Signal& s) {
+    const SignalConfig& c = s.config;
+    int32_t margin = c.alarmBelow ? s.lastValue - c.threshold : c.threshold - s.lastValue;
+    return margin < c.nearBand;
+  }
+
+  static uint16_t urgencyOf(const Signal& s) {
+    const SignalConfig& c = s.config;
+    int32_t margin = c.alarmBelow ? s.lastValue - c.threshold : c.threshold - s.lastValue;
+    if (margin <= 0) return SAMPLER_URGENCY_MAX;
+
+    uint32_t proximity = 0;
+    if (margin < c.nearBand) {
+      proximity = (uint32_t)(c.nearBand - margin) * SAMPLER_URGENCY_MAX / c.nearBand;
+    }
+
+    uint32_t slope = s.slope < 0 ? -s.slope : s.slope;
+    uint32_t activity = c.fastSlope > 0 ? slope * SAMPLER_URGENCY_MAX / c.fastSlope : 0;
+
+    uint32_t u = proximity > activity ? proximity : activity;
+    return (uint16_t)(u > SAMPLER_URGENCY_MAX ? SAMPLER_URGENCY_MAX : u);
+  }
+
+  // Sampling rate rises linearly with urgency from 1/maxPeriod to 1/minPeriod
+  static uint32_t periodFor(const SignalConfig& c, uint16_t urgency) {
+    uint64_t num = (uint64_t)c.maxPeriodMs * c.minPeriodMs * SAMPLER_URGENCY_MAX;
+    uint64_t den = (uint64_t)c.minPeriodMs * (SAMPLER_URGENCY_MAX - urgency)
+                 + (uint64_t)c.maxPeriodMs * urgency;
+    return den ? (uint32_t)(num / den) : c.minPeriodMs;
+  }
+
+  uint32_t budgetDepth() const {
+    uint32_t maxCost = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      if (signals[i].config.cost > maxCost) maxCost = signals[i].config.cost;
+    }
+    return (uint32_t)((uint64_t)budgetUnits * 1000 * SAMPLER_BURST_MS / budgetPeriodMs) + maxCost * 1000;
+  }
+
+  // Exact to the unit over any run of calls: the fraction of a milli-unit carries over
+  void refill(uint32_t nowMs) {
+    uint32_t dtMs = nowMs - lastRefillMs;
+    lastRefillMs = nowMs;
+    uint64_t gained = (uint64_t)budgetUnits * 1000 * dtMs + refillRemainder;
+    refillRemainder = (uint32_t)(gained % budgetPeriodMs);
+    int64_t tokens = (int64_t)tokensMilli + (int64_t)(gained / budgetPeriodMs);
+    int64_t depth = budgetDepth();
+    tokensMilli = (int32_t)(tokens > depth ? depth : tokens);
+  }
+
+  uint32_t budgetUnits;
+  uint32_t budgetPeriodMs;
+  Signal signals[SAMPLER_MAX_SIGNALS];
+  uint8_t count;
+  int32_t tokensMilli;    // Budget units * 1000
+  uint32_t lastRefillMs;
+  uint32_t refillRemainder;
+  SamplerStats stats;
+};
+
+// SmartTrack's DTC-checked signals, in hundredths of a degree / volt, for a
+// board that used to read both and send a telemetry frame every
+// samplePeriodMs. The budget matches that fixed rate; stable signals fall
+// back to it and spend the savings near the 40 C / 11.8 V thresholds.
+// Coolant backs off to twice the old period when stable, but never past
+// the old period within 5 C of its threshold. At full urgency it reads
+// every 900 ms, a little faster than the old 1 s and just slower than the
+// conversion.
+// Shared by the firmware and backend/sampling_replay.cpp.
+#define COOLANT_SAMPLE_COST   4       // Blocking DS18B20 conversion (~750 ms)
+#define BATTERY_SAMPLE_COST   1       // One ADC read
+#define TELEMETRY_FRAME_COST  1       // One uplink frame, charged per window with a sample
+
+inline SignalConfig coolantSignalConfig(uint32_t samplePeriodMs) {
+  SignalConfig c = {900, 2 * samplePeriodMs, samplePeriodMs, 4000, false, 500, 10, COOLANT_SAMPLE_COST};
+  return c;
+}
+
+inline SignalConfig batterySignalConfig(uint32_t samplePeriodMs) {
+  SignalConfig c = {200, samplePeriodMs, samplePeriodMs, 1180, true, 50, 20, BATTERY_SAMPLE_COST};
+  return c;
+}
+
+// Budget units per sample period: what one fixed-rate window cost
+#define SMARTTRACK_WINDOW_COST (COOLANT_SAMPLE_COST + BATTERY_SAMPLE_COST + TELEMETRY_FRAME_COST)
+
+#endif
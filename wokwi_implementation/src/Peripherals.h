@@ -0,0 +1,302 @@
+#ifndef PERIPHERALS_H
+#define PERIPHERALS_H
+
+// Peripheral wrappers selected by BoardProfile.
+// The primary templates are empty inline stand-ins for absent hardware, so
+// calls to them compile to nothing. The <true> specialisations, and the
+// libraries they need, are only compiled for boards that have the device.
+
+#include <Arduino.h>
+#include "BoardProfile.h"
+
+#if BOARD_HAS_TEMP_SENSOR
+#include <OneWire.h>
+#include <DallasTemperature.h>
+#endif
+#if BOARD_HAS_GPS
+#include <TinyGPSPlus.h>
+#endif
+#if BOARD_HAS_GSM
+#include <SoftwareSerial.h>
+#endif
+#if BOARD_HAS_LCD
+#include <LiquidCrystal_I2C.h>
+#endif
+#if BOARD_HAS_WIFI
+#include <WiFi.h>
+#endif
+#if BOARD_UPLINK_TLS
+#include <WiFiClientSecure.h>
+#endif
+
+// DS18B20 Configuration
+#define ONE_WIRE_BUS 15       // GPIO15 for DS18B20 data
+
+// GPS Configuration
+#define RXD2 16               // GPS RX
+#define TXD2 17               // GPS TX
+#define GPS_POWER_PIN 25       // High switches on the GPS supply (load switch with pull-down)
+#define GPS_BAUD 9600
+#define GPS_FIX_TIMEOUT_MS 2000 // A fix older than this counts as signal lost
+#define GPS_EPOCH_MS 1000       // NEO-6M sends one NMEA burst per second
+#define GPS_QUIET_MS 20         // Silence that ends a burst (characters are ~1 ms apart)
+#define GPS_WAKE_LEAD_MS 30     // Wake this long before the next burst; less than a window's work
+#define GPS_RX_BUFFER 1024      // Holds a whole burst while the loop is busy
+
+// GSM Configuration
+#define RXD1 9                // GSM RX
+#define TXD1 10               // GSM TX
+
+// Coolant temperature sensor. Without hardware the value is set by the test harness.
+template <bool Present>
+class TemperatureSensor {
+public:
+  void begin() {}
+  float readCelsius() { return simulatedTemp; }
+  void setSimulated(float temp) { simulatedTemp = temp; }
+private:
+  float simulatedTemp = 25.0;
+};
+
+#if BOARD_HAS_TEMP_SENSOR
+template <>
+class TemperatureSensor<true> {
+public:
+  TemperatureSensor() : oneWire(ONE_WIRE_BUS), sensors(&oneWire) {}
+
+  void begin() {
+    sensors.begin();            // Initialize DS18B20 temperature sensor
+  }
+
+  float readCelsius() {
+    sensors.requestTemperatures();
+    return sensors.getTempCByIndex(0);
+  }
+
+private:
+  OneWire oneWire;
+  DallasTemperature sensors;
+};
+#endif
+
+// NEO-6M GPS receiver
+template <bool Present>
+class GpsModule {
+public:
+  void begin() {}
+  void poll() {}
+  void finishBurst() {}
+  uint32_t wakeBefore(uint32_t dueMs, uint32_t) { return dueMs; }
+  bool hasFix() { return false; }
+  bool newFix() { return false; }
+  int32_t latE7() { return 0; }
+  int32_t lonE7() { return 0; }
+  bool hasCourse() { return false; }
+  int32_t courseCentiDeg() { return 0; }
+};
+
+#if BOARD_HAS_GPS
+template <>
+class GpsModule<true> {
+public:
+  GpsModule() : gpsSerial(2), burstBytes(0), burstStartMs(0), burstKnown(false) {} // Use UART2 for GPS communication
+
+  void begin() {
+    gpsSerial.setRxBufferSize(GPS_RX_BUFFER);
+    gpsSerial.begin(GPS_BAUD, SERIAL_8N1, RXD2, TXD2);
+  }
+
+  // Feed pending NMEA bytes to the parser
+  void poll() {
+    while (gpsSerial.available() > 0) {
+      gps.encode(gpsSerial.read());
+      burstBytes++;
+    }
+  }
+
+  // Stay awake until the current NMEA burst has ended, so light sleep does
+  // not cut into it, and note when it started. Without a known burst time,
+  // wait up to one epoch for the next burst to resynchronise.
+  void finishBurst() {
+    uint32_t start = millis();
+    uint32_t lastByteMs = start;
+    bool heard = false;
+    uint32_t waitMs = burstKnown ? GPS_QUIET_MS : GPS_EPOCH_MS;
+    for (;;) {
+      uint32_t now = millis();
+      if (gpsSerial.available() > 0) {
+        poll();
+        heard = true;
+        lastByteMs = now;
+        continue;
+      }
+      if (heard ? now - lastByteMs >= GPS_QUIET_MS : now - start >= waitMs) break;
+      if (now - start >= 2 * GPS_EPOCH_MS) break;
+      delay(1);
+    }
+    // Bytes of a burst arrive back to back, 10 bits each
+    burstKnown = heard;
+    if (heard) burstStartMs = lastByteMs - (uint32_t)(burstBytes * 10000UL / GPS_BAUD);
+    burstBytes = 0;
+  }
+
+  // The earlier of dueMs and just before the next NMEA burst
+  uint32_t wakeBefore(uint32_t dueMs, uint32_t nowMs) {
+    if (!burstKnown) return dueMs;
+    uint32_t next = burstStartMs + GPS_EPOCH_MS - GPS_WAKE_LEAD_MS;
+    while ((int32_t)(next - nowMs) <= 0) next += GPS_EPOCH_MS;
+    return (int32_t)(next - dueMs) < 0 ? next : dueMs;
+  }
+
+  bool hasFix() {
+    return gps.location.isValid() && gps.location.age() < GPS_FIX_TIMEOUT_MS;
+  }
+
+  // True once per decoded fix
+  bool newFix() {
+    return hasFix() && gps.location.isUpdated();
+  }
+
+  // Position in 1e-7 degrees, straight from the parser's integer fields
+  int32_t latE7() { return rawToE7(gps.location.rawLat()); }
+  int32_t lonE7() { return rawToE7(gps.location.rawLng()); }
+
+  bool hasCourse() {
+    return gps.course.isValid() && gps.course.age() < GPS_FIX_TIMEOUT_MS;
+  }
+
+  int32_t courseCentiDeg() { return gps.course.value(); }
+
+private:
+  static int32_t rawToE7(const RawDegrees& raw) {
+    int32_t value = (int32_t)raw.deg * 10000000L + (int32_t)(raw.billionths / 100);
+    return raw.negative ? -value : value;
+  }
+
+  HardwareSerial gpsSerial;
+  TinyGPSPlus gps;
+  uint32_t burstBytes;     // Read since the last burst ended
+  uint32_t burstStartMs;
+  bool burstKnown;
+};
+#endif
+
+// SIM800L GSM modem
+template <bool Present>
+class GsmModule {
+public:
+  void begin() {}
+  void sendSMS(const String&, const String&) {}
+};
+
+#if BOARD_HAS_GSM
+template <>
+class GsmModule<true> {
+public:
+  GsmModule() : gsmSerial(RXD1, TXD1) {} // Use SoftwareSerial for GSM communication
+
+  void begin() {
+    gsmSerial.begin(9600);      // GSM module baud rate is 9600
+  }
+
+  // Send an SMS in text mode
+  void sendSMS(const String& phoneNumber, const String& message) {
+    gsmSerial.println("AT+CMGF=1");             // Set SMS mode to text
+    delay(100);
+
+    gsmSerial.println("AT+CMGS=\"" + phoneNumber + "\"");   // Set recipient number
+    delay(100);
+
+    gsmSerial.print(message);                  // Send message content
+    delay(100);
+
+    gsmSerial.write(26);                       // Ctrl+Z to send SMS
+  }
+
+private:
+  SoftwareSerial gsmSerial;
+};
+#endif
+
+// 16x2 I2C LCD
+template <bool Present>
+class LcdDisplay {
+public:
+  void init() {}
+  void backlight() {}
+  void clear() {}
+  void setCursor(uint8_t, uint8_t) {}
+  template <typename T> void print(const T&) {}
+  template <typename T> void print(const T&, int) {}
+};
+
+#if BOARD_HAS_LCD
+template <>
+class LcdDisplay<true> {
+public:
+  LcdDisplay() : lcd(0x27, 16, 2) {} // I2C address 0x27, 16 columns, 2 rows
+
+  void init() { lcd.init(); }
+  void backlight() { lcd.backlight(); }
+  void clear() { lcd.clear(); }
+  void setCursor(uint8_t col, uint8_t row) { lcd.setCursor(col, row); }
+  template <typename T> void print(const T& value) { lcd.print(value); }
+  template <typename T> void print(const T& value, int format) { lcd.print(value, format); }
+
+private:
+  LiquidCrystal_I2C lcd;
+};
+#endif
+
+// Network link for the cloud uplink. Without WiFi the client never connects.
+class NullClient {
+public:
+  int connect(const char*, uint16_t) { return 0; }
+  uint8_t connected() { return 0; }
+  size_t write(const uint8_t*, size_t) { return 0; }
+  int available() { return 0; }
+  int read() { return -1; }
+  void stop() {}
+};
+
+template <bool Present>
+class NetworkLink {
+public:
+  typedef NullClient Client;
+  void begin() {}
+  void secure(Client&) {}
+  bool up() { return false; }
+};
+
+#if BOARD_HAS_WIFI
+template <>
+class NetworkLink<true> {
+public:
+#if BOARD_UPLINK_TLS
+  typedef WiFiClientSecure Client;
+#else
+  typedef WiFiClient Client;
+#endif
+
+  // Join the access point in the background; the uplink retries until it is up
+  void begin() {
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(BOARD_WIFI_SSID, BOARD_WIFI_PASSWORD);
+    // Modem sleep keeps the association through PowerManager's light sleep
+    WiFi.setSleep(true);
+  }
+
+  // Trust only the broker's CA when the uplink runs over TLS
+  void secure(Client& client) {
+#if BOARD_UPLINK_TLS
+    client.setCACert(UPLINK_CA_CERT);
+#else
+    (void)client;
+#endif
+  }
+
+  bool up() { return WiFi.status() == WL_CONNECTED; }
+};
+#endif
+
+#endif
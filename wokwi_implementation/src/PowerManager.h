@@ -0,0 +1,267 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+// Sleeps the ESP32 between sampling windows according to PowerPolicy.
+// Light sleep wakes on the window timer or the ignition/motion input; deep
+// sleep wakes on the check-in timer or the ignition input and restarts the
+// firmware. Serial lines are not wake sources: a level wake fires on every
+// start bit and loses the byte, and the ESP32's UART wake needs GPIO9, a
+// flash pin. Instead the GPS is switched off while parked, and while
+// driving the caller stays awake through each NMEA burst (see
+// GpsModule::finishBurst). Energy counters live in RTC memory so they
+// survive deep sleep. Other builds just delay().
+//
+// Forcing light sleep with esp_light_sleep_start() powers the radio down,
+// so boards with WiFi (field, Wokwi) would drop the uplink every window.
+// Those keep WiFi associated in modem sleep (NetworkLink::begin) and
+// instead enable automatic light sleep with esp_pm_configure(): the loop
+// task blocks until the next window or an ignition change, and the idle
+// task sleeps in between, waking for DTIM beacons. If the core was built
+// without power management (CONFIG_PM_ENABLE and tickless idle), the wait
+// still happens with WiFi up, just without light sleep, and is counted as
+// modem sleep. Boards without WiFi light-sleep explicitly as before.
+
+#include <Arduino.h>
+#include "BoardProfile.h"
+#include "PowerPolicy.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <driver/gpio.h>
+#include <sys/time.h>
+#define POWER_RTC_DATA RTC_DATA_ATTR
+#if BOARD_HAS_WIFI
+#include <esp_pm.h>
+#include <esp_idf_version.h>
+#define POWER_AUTO_LIGHT_SLEEP 1
+#endif
+#else
+#define POWER_RTC_DATA
+#endif
+
+#define POWER_PM_MAX_MHZ 240
+#define POWER_PM_MIN_MHZ 80   // Lowest APB-safe clock while WiFi is up
+
+#define IGNITION_PIN 27       // Ignition/motion input, high while the engine is on
+
+POWER_RTC_DATA EnergyCounters powerCounters;
+POWER_RTC_DATA bool powerDeepSleeping = false;
+POWER_RTC_DATA int64_t powerDeepSleepStartUs = 0;   // RTC wall time when deep sleep began
+
+#if defined(POWER_AUTO_LIGHT_SLEEP)
+static TaskHandle_t powerWaiter = NULL;
+
+// The ignition level changed while waiting for the next window: stop waiting
+static void IRAM_ATTR powerIgnitionChanged(void*) {
+  gpio_intr_disable((gpio_num_t)IGNITION_PIN);
+  BaseType_t woken = pdFALSE;
+  if (powerWaiter) vTaskNotifyGiveFromISR(powerWaiter, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+#endif
+
+class PowerManager {
+public:
+  // gpsPowerPin drives the GPS supply switch; -1 if the board has no GPS
+  PowerManager(uint32_t drivingPeriodMs, int gpsPowerPin)
+    : policy(drivingPeriodMs), gpsPowerPin(gpsPowerPin), windowStartMs(0), resumed(false),
+      wokeDeep(false), gpsOn(false), autoLightSleep(false) {}
+
+  void begin(bool hasIgnition) {
+    ignitionInput = hasIgnition;
+    if (ignitionInput) pinMode(IGNITION_PIN, INPUT_PULLDOWN);
+
+#if defined(ARDUINO_ARCH_ESP32)
+    esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+    resumed = powerDeepSleeping && cause == ESP_SLEEP_WAKEUP_TIMER;
+    wokeDeep = powerDeepSleeping;
+    if (powerDeepSleeping) {
+      // The RTC keeps wall time through deep sleep
+      powerCounters.deepSleepMs += (uint64_t)(rtcMicros() - powerDeepSleepStartUs) / 1000;
+      powerCounters.wakeups++;
+    } else if (cause == ESP_SLEEP_WAKEUP_UNDEFINED) {
+      powerCounters = EnergyCounters();   // Power-on reset
+    }
+#endif
+    powerDeepSleeping = false;
+#if defined(POWER_AUTO_LIGHT_SLEEP)
+    beginAutoLightSleep();
+#endif
+    policy.begin(millis(), resumed);
+    windowStartMs = millis();
+    if (gpsPowerPin >= 0) pinMode(gpsPowerPin, OUTPUT);
+    setGpsPower(!resumed);   // A parked check-in does not need a fix
+  }
+
+  // Woken by a deep-sleep check-in timer rather than a power-on or ignition
+  bool resumedFromDeepSleep() const {
+    return resumed;
+  }
+
+  // Woken from deep sleep by any source, so RTC memory still holds the last state
+  bool wokeFromDeepSleep() const {
+    return wokeDeep;
+  }
+
+  bool gpsPowered() const {
+    return gpsOn;
+  }
+
+  bool ignitionOn() const {
+    return ignitionInput && digitalRead(IGNITION_PIN) == HIGH;
+  }
+
+  uint8_t mode() const {
+    return policy.mode();
+  }
+
+  // Start the next driving window at dueMs (millis()) rather than a fixed period later
+  void setNextWindow(uint32_t dueMs) {
+    int32_t periodMs = (int32_t)(dueMs - windowStartMs);
+    policy.setDrivingPeriod(periodMs > 0 ? (uint32_t)periodMs : 0);
+  }
+
+  // Close the current sampling window and sleep until the next one.
+  // beforeDeepSleep (optional) runs first when the device is about to deep sleep.
+  // Returns the decision taken; a deep sleep does not return on the ESP32.
+  PowerDecision endWindow(int speedKmh, void (*beforeDeepSleep)() = NULL) {
+    uint32_t now = millis();
+    uint32_t workMs = now - windowStartMs;
+    powerCounters.awakeMs += workMs;
+
+    PowerDecision d = policy.decide(now, speedKmh, ignitionOn(), workMs);
+    setGpsPower(d.gpsPowered);
+    if (d.deep) {
+      if (beforeDeepSleep) beforeDeepSleep();
+      enterDeepSleep(d.sleepMs);
+    } else if (d.sleepMs > 0) {
+      lightSleep(d);
+    }
+    windowStartMs = millis();
+    return d;
+  }
+
+  const EnergyCounters& counters() const {
+    return powerCounters;
+  }
+
+  void printReport(Print& out) const {
+    out.print("POWER awake=");
+    out.print((unsigned long)(powerCounters.awakeMs / 1000));
+    out.print("s light=");
+    out.print((unsigned long)(powerCounters.lightSleepMs / 1000));
+    out.print("s wifi=");
+    out.print((unsigned long)(powerCounters.wifiSleepMs / 1000));
+    out.print("s modem=");
+    out.print((unsigned long)(powerCounters.modemSleepMs / 1000));
+    out.print("s deep=");
+    out.print((unsigned long)(powerCounters.deepSleepMs / 1000));
+    out.print("s avg=");
+    out.print(powerAverageMicroAmps(powerCounters) / 1000.0, 2);
+    out.println("mA");
+  }
+
+private:
+  // The supply switch has a pull-down, so the GPS also stays off through deep sleep
+  void setGpsPower(bool on) {
+    if (gpsPowerPin < 0) return;
+    digitalWrite(gpsPowerPin, on ? HIGH : LOW);
+    gpsOn = on;
+  }
+
+#if defined(POWER_AUTO_LIGHT_SLEEP)
+  void beginAutoLightSleep() {
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_pm_config_t pm;
+#else
+    esp_pm_config_esp32_t pm;
+#endif
+    pm.max_freq_mhz = POWER_PM_MAX_MHZ;
+    pm.min_freq_mhz = POWER_PM_MIN_MHZ;
+    pm.light_sleep_enable = true;
+    autoLightSleep = esp_pm_configure(&pm) == ESP_OK;
+    if (ignitionInput) {
+      gpio_install_isr_service(0);   // Already installed by attachInterrupt() is fine
+      gpio_isr_handler_add((gpio_num_t)IGNITION_PIN, powerIgnitionChanged, NULL);
+      gpio_intr_disable((gpio_num_t)IGNITION_PIN);
+      esp_sleep_enable_gpio_wakeup();
+    }
+  }
+
+  // Block until the next window with WiFi still associated. The idle task
+  // light-sleeps meanwhile if power management is on.
+  void lightSleep(const PowerDecision& d) {
+    powerWaiter = xTaskGetCurrentTaskHandle();
+    ulTaskNotifyTake(pdTRUE, 0);   // Drop a stale ignition notification
+    if (ignitionInput) {
+      // Level wake, the opposite of the current state, which also arms the interrupt
+      gpio_wakeup_enable((gpio_num_t)IGNITION_PIN,
+                         ignitionOn() ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+      gpio_intr_enable((gpio_num_t)IGNITION_PIN);
+    }
+
+    int64_t start = esp_timer_get_time();
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(d.sleepMs));
+    if (ignitionInput) gpio_intr_disable((gpio_num_t)IGNITION_PIN);
+    uint64_t sleptMs = (esp_timer_get_time() - start) / 1000;
+    if (autoLightSleep) powerCounters.wifiSleepMs += sleptMs;
+    else powerCounters.modemSleepMs += sleptMs;
+    powerCounters.wakeups++;
+  }
+#else
+  void lightSleep(const PowerDecision& d) {
+#if defined(ARDUINO_ARCH_ESP32)
+    Serial.flush();
+    esp_sleep_enable_timer_wakeup((uint64_t)d.sleepMs * 1000);
+    if (ignitionInput) {
+      gpio_wakeup_enable((gpio_num_t)IGNITION_PIN,
+                         ignitionOn() ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+      esp_sleep_enable_gpio_wakeup();
+    }
+
+    int64_t start = esp_timer_get_time();
+    esp_light_sleep_start();
+    powerCounters.lightSleepMs += (esp_timer_get_time() - start) / 1000;
+    powerCounters.wakeups++;
+#else
+    delay(d.sleepMs);
+    powerCounters.lightSleepMs += d.sleepMs;
+#endif
+  }
+#endif
+
+  void enterDeepSleep(uint32_t sleepMs) {
+#if defined(ARDUINO_ARCH_ESP32)
+    powerDeepSleepStartUs = rtcMicros();
+    powerDeepSleeping = true;
+    Serial.flush();
+    esp_sleep_enable_timer_wakeup((uint64_t)sleepMs * 1000);
+    if (ignitionInput) esp_sleep_enable_ext0_wakeup((gpio_num_t)IGNITION_PIN, 1);
+    esp_deep_sleep_start();
+#else
+    delay(sleepMs);
+    powerCounters.deepSleepMs += sleepMs;
+    powerCounters.wakeups++;
+#endif
+  }
+
+#if defined(ARDUINO_ARCH_ESP32)
+  static int64_t rtcMicros() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+  }
+#endif
+
+  PowerPolicy policy;
+  int gpsPowerPin;
+  uint32_t windowStartMs;
+  bool resumed;
+  bool wokeDeep;
+  bool gpsOn;
+  bool ignitionInput;
+  bool autoLightSleep;    // esp_pm_configure() accepted light_sleep_enable
+};
+
+#endif
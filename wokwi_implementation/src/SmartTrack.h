@@ -0,0 +1,732 @@
+#ifndef SMARTTRACK_H
+#define SMARTTRACK_H
+
+// SmartTrack firmware, shared by every board.
+// Entry points (codes/Arduino_Code.cpp, codes/Wokwi_code.cpp,
+// wokwi_implementation/sketch.ino) select the board with SMARTTRACK_BOARD
+// and include this file exactly once.
+
+#include <Arduino.h>
+#include "BoardProfile.h"
+#include "Peripherals.h"
+#include "DriverBehavior.h"
+#include "MemoryTelemetry.h"
+#include "PositionFilter.h"
+#include "Uplink.h"
+#include "PowerManager.h"
+#include "AdaptiveSampler.h"
+
+// Potentiometer Configuration
+#define POT_PIN 34            // Analog pin for potentiometer
+
+// Pin Definitions
+#define ALERT_LED 2           // LED pin
+#define BUZZER_PIN 4          // Buzzer pin
+
+// Peripherals present on this board; absent ones compile to nothing
+TemperatureSensor<BoardProfile::hasTempSensor> tempSensor;
+GpsModule<BoardProfile::hasGps> gps;
+GsmModule<BoardProfile::hasGsm> gsm;
+LcdDisplay<BoardProfile::hasLcd> lcd;
+NetworkLink<BoardProfile::hasWifi> network;
+
+// Batched MQTT uplink to the cloud dashboard
+#define UPLINK_BACKLOG_DECIMATE 4  // While backlogged, send only every 4th telemetry frame
+NetworkLink<BoardProfile::hasWifi>::Client uplinkClient;
+Uplink<NetworkLink<BoardProfile::hasWifi>::Client> uplink(uplinkClient);
+uint8_t uplinkSkipped = 0;
+#define UPLINK_FLUSH_MS 5000       // Time allowed to deliver queued data before deep sleep
+
+// Duty cycling between sampling windows
+PowerManager powerManager(BoardProfile::samplePeriodMs, BoardProfile::hasGps ? GPS_POWER_PIN : -1);
+
+// Adaptive sampling of the DTC-checked signals (configs in AdaptiveSampler.h).
+// The budget is one fixed-rate window (both reads and a telemetry frame) per
+// sample period; each frame sent is charged against it too.
+AdaptiveSampler sampler(SMARTTRACK_WINDOW_COST, BoardProfile::samplePeriodMs);
+int coolantSignal = sampler.addSignal(coolantSignalConfig(BoardProfile::samplePeriodMs));
+int batterySignal = sampler.addSignal(batterySignalConfig(BoardProfile::samplePeriodMs));
+float lastCoolantTemp = 25.0;  // Most recent reading, reused until the next sample is due
+
+// Mock OBD-II parameters with initial values
+String engineRPM = "1200";
+String coolantTemp = "82";
+String batteryVoltage = "12.6";
+String throttlePosition = "15";
+String fuelLevel = "75";
+String timingAdvance = "12.5";
+String engineLoad = "34";
+String speed = "0";
+bool engineCheck = false;
+
+// Mock GPS parameters (if GPS module fails)
+#define MOCK_LAT_E7 129715980L    // Example: Bangalore, India
+#define MOCK_LON_E7 775945660L
+float latitude = 12.971598;
+float longitude = 77.594566;
+bool gpsFix = false;
+
+// Position fusion between GPS fixes
+PositionFilter positionFilter;
+POWER_RTC_DATA PositionState savedPosition;  // Estimate at the last deep sleep
+unsigned long lastPositionMs = 0;
+int32_t simulatedHeading = 0;  // Centidegrees, boards without GPS
+
+// DTC Management
+String activeDTCs[3] = {"", "", ""};
+bool hasDTCs = false;
+int dtcCounter = 0;
+
+// Driver behaviour analysis
+DriverBehavior driverBehavior;
+uint8_t lastPowerMode = POWER_DRIVING;  // To spot the parked -> driving transition that starts a trip
+
+// Heap and stack telemetry
+MemoryTelemetry memoryTelemetry;
+
+// Buzzer test state
+bool buzzerTestMode = true;
+unsigned long buzzerTestStartTime = 0;
+const unsigned long BUZZER_TEST_DURATION = 5000; // 5 seconds test duration
+
+// Debug flag
+bool debugMode = true;
+
+void runBuzzerTest();
+void runCycle(float currentTemp);
+void updateOBDParameters(float currentTemp);
+void checkAndGenerateDTCs(float currentTemp);
+bool addDTC(String code, String description);
+bool removeDTC(String code);
+void clearDTCs();
+void updateLCD(float temp);
+void sendAlert(String message);
+void sendSMS(String phoneNumber, String message);
+void updateGPS();
+bool queueTelemetry(float temp);
+void queueDTCEvent(String code, bool onset);
+void beforeDeepSleep();
+void flushUplink();
+void reportDriverEvents(uint8_t events);
+void endTrip();
+void displayEnhancedDashboard(float temp);
+void displayDTCs();
+void printSpaces(int count);
+
+void setup() {
+  Serial.begin(115200);
+  memoryTelemetry.begin();  // Track the loop task's stack from here
+  powerManager.begin(BoardProfile::hasIgnition);
+  bool checkIn = powerManager.resumedFromDeepSleep(); // Parked check-in: skip the start-up show
+  pinMode(ALERT_LED, OUTPUT);
+  pinMode(BUZZER_PIN, OUTPUT);
+  pinMode(POT_PIN, INPUT);
+
+  tempSensor.begin();
+  gps.begin();
+  if (powerManager.wokeFromDeepSleep() && savedPosition.valid) {
+    positionFilter.restore(savedPosition); // Still parked where it went to sleep
+  } else {
+    positionFilter.reset(MOCK_LAT_E7, MOCK_LON_E7, POS_MAX_VARIANCE_M2); // Unknown until the first fix
+  }
+  lastPositionMs = millis();
+  gsm.begin();
+  network.begin();
+  network.secure(uplinkClient);
+
+  lcd.init();      // Initialize LCD
+  lcd.backlight(); // Turn on backlight
+  
+  if (checkIn) {
+    buzzerTestMode = false;
+    Serial.println("Parked check-in");
+    return;
+  }
+
+  lcd.setCursor(0, 0);
+  lcd.print("Vehicle System");
+  if (BoardProfile::hasLcd) {
+    delay(2000); // Display startup message for 2 seconds
+  }
+  
+  Serial.println("\n============================================");
+  Serial.println("Enhanced Vehicle Diagnostics System");
+  Serial.println("============================================");
+  
+  sendSMS("+1234567890", "System Initialized!"); // Test SMS on startup
+
+  Serial.println("Starting buzzer test sequence...");
+  buzzerTestStartTime = millis();
+}
+
+void loop() {
+  // First, handle buzzer test if active
+  if (buzzerTestMode) {
+    runBuzzerTest();
+    return; // Skip regular monitoring during test
+  }
+
+  // Periodic heap/stack sample
+  if (memoryTelemetry.sample(millis())) {
+    if (debugMode) {
+      memoryTelemetry.printReport(Serial);
+      powerManager.printReport(Serial);
+    }
+    if (BoardProfile::hasWifi) {
+      const MemorySample& mem = memoryTelemetry.latest();
+      MemoryRecord record = MemoryRecord();
+      record.freeHeap = mem.freeHeap;
+      record.largestBlock = mem.largestFreeBlock;
+      record.minFreeHeap = mem.minFreeHeap;
+      record.fragmentationPct = mem.fragmentationPct;
+      record.stackCount = mem.taskCount < UPLINK_MAX_STACKS ? mem.taskCount : UPLINK_MAX_STACKS;
+      for (uint8_t i = 0; i < record.stackCount; i++) {
+        record.stackHighWater[i] = mem.stackHighWater[i];
+      }
+      uplink.offerMemory(millis(), record);
+    }
+  }
+
+  // Read only the signals whose adaptive schedule is due; the others keep their last value
+  uint8_t dueSignals = sampler.due(millis());
+
+  // Read actual temperature from DS18B20 sensor
+  if (dueSignals & (1 << coolantSignal)) {
+    lastCoolantTemp = tempSensor.readCelsius();
+    sampler.record(coolantSignal, millis(), (int32_t)(lastCoolantTemp * 100));
+  }
+  float currentTemp = lastCoolantTemp;
+
+  // Read potentiometer value and map it to battery voltage range (11.0V - 13.0V)
+  if (dueSignals & (1 << batterySignal)) {
+    int potValue = analogRead(POT_PIN);
+    float voltage = map(potValue, 0, 4095, 110, 130) / 10.0;
+    batteryVoltage = String(voltage, 1); // Format to one decimal place
+    sampler.record(batterySignal, millis(), (int32_t)(voltage * 100 + 0.5));
+
+    if (debugMode) {
+      Serial.print("Potentiometer raw value: ");
+      Serial.print(potValue);
+      Serial.print(", Mapped battery voltage: ");
+      Serial.println(batteryVoltage);
+    }
+  }
+
+  // The rest of the cycle runs only when a signal was sampled, so the
+  // telemetry rate follows the sampler and its budget
+  if (dueSignals) {
+    runCycle(currentTemp);
+  }
+
+  // Service the connection every pass; acks and reconnects are not sampled work
+  if (BoardProfile::hasWifi && network.up()) {
+    uplink.poll(millis());
+  }
+
+  // Sleep until the next signal is due instead of busy-waiting. While the GPS
+  // is on, finish receiving its NMEA burst first and wake before the next one.
+  unsigned long nextDue = sampler.nextDueMs(millis());
+  if (powerManager.gpsPowered()) {
+    gps.finishBurst();
+    nextDue = gps.wakeBefore(nextDue, millis());
+  }
+  powerManager.setNextWindow(nextDue);
+  PowerDecision power = powerManager.endWindow(speed.toInt(), beforeDeepSleep);
+
+  // Ignition on or first motion after a stop: the last trip is over
+  if (power.mode == POWER_DRIVING && lastPowerMode != POWER_DRIVING) {
+    endTrip();
+  }
+  lastPowerMode = power.mode;
+}
+
+// One sampling cycle: OBD update, scoring, DTC checks, telemetry and displays
+void runCycle(float currentTemp) {
+  // Update simulated OBD-II parameters with realistic values
+  updateOBDParameters(currentTemp);
+
+  // Score driving style from this cycle's speed, throttle and RPM; parked
+  // windows are not part of a trip
+  if (powerManager.mode() == POWER_DRIVING) {
+    uint8_t driverEvents = driverBehavior.update(millis(), speed.toInt(), throttlePosition.toInt(), engineRPM.toInt());
+    if (driverEvents) {
+      reportDriverEvents(driverEvents);
+    }
+  }
+
+  // Check and generate DTCs based on current parameters
+  checkAndGenerateDTCs(currentTemp);
+
+  // Queue this cycle's telemetry for the cloud; the frame is paid for from the sampling budget
+  if (BoardProfile::hasWifi && queueTelemetry(currentTemp)) {
+    sampler.charge(millis(), TELEMETRY_FRAME_COST);
+  }
+
+  // Control LED based on DTC status
+  if (hasDTCs) {
+    digitalWrite(ALERT_LED, HIGH); // Turn on LED if there are active DTCs
+    sendSMS("+1234567890", "Active DTC detected! Check vehicle status.");
+  } else {
+    digitalWrite(ALERT_LED, LOW); // Turn off LED if no DTCs are active
+  }
+
+  displayEnhancedDashboard(currentTemp);
+
+  if (hasDTCs) {
+    displayDTCs();
+    sendSMS("+1234567890", "Active DTCs: Check diagnostics.");
+    if (BoardProfile::hasGsm) {
+      delay(10000); // Send SMS every cycle for testing purposes.
+    }
+  }
+  // Update LCD display with diagnostics data
+  updateLCD(currentTemp);
+}
+
+void updateOBDParameters(float currentTemp) {
+    int baseRPM = 800; // Idle RPM
+  int throttle = throttlePosition.toInt();
+  
+  int rpm;
+  
+  if (engineCheck) {
+    rpm = baseRPM + random(0, 200) + (throttle * random(10,20));
+  } else {
+    rpm = baseRPM + throttle * random(50,100); 
+  }
+  engineRPM = String(rpm);
+
+  // Calculate new fuel level (ensure non-negative)
+  int newFuel = fuelLevel.toInt() - random(0, 2);
+  if (newFuel < 0) newFuel = 0;
+  fuelLevel = String(newFuel);
+  
+  coolantTemp = String((int)currentTemp); 
+  timingAdvance = String(8 + (random(0, 10) / 2.0));
+  engineLoad = String(20 + (throttle / 2) + random(0, 15));
+
+  // Fixed speed calculation to ensure non-negative values
+  int currentSpeed = speed.toInt();
+
+  if (throttle > 10) {
+    currentSpeed = currentSpeed + random(-2, 5);
+  } else {
+    currentSpeed = currentSpeed - random(1, 4);
+  }
+  // Ensure speed stays within valid range
+  if (currentSpeed < 0) currentSpeed = 0;
+  if (currentSpeed > 120) currentSpeed = 120;
+  
+  speed = String(currentSpeed);
+
+  // Without a GPS, wander the heading to simulate a drive
+  if (!BoardProfile::hasGps && currentSpeed > 0) {
+    simulatedHeading += random(-500, 500);
+    positionFilter.setHeading(simulatedHeading);
+  }
+
+  // Dead-reckon from speed, then correct with GPS when there is a fix
+  unsigned long now = millis();
+  positionFilter.predict(now - lastPositionMs, currentSpeed);
+  lastPositionMs = now;
+  updateGPS();
+  latitude = positionFilter.latE7Estimate() / 1e7;
+  longitude = positionFilter.lonE7Estimate() / 1e7;
+}
+
+void checkAndGenerateDTCs(float currentTemp){
+  bool dtcStatusChanged = false;
+  
+  // Temperature-based DTC
+  if (currentTemp > 40.0) {
+    if (addDTC("P0118", "Engine Coolant Temperature Circuit High")) {
+      dtcStatusChanged = true;
+    }
+    // Also trigger an alert when temperature is critical
+    sendAlert("ENGINE OVERHEATING: " + String(currentTemp, 1) + "°C");
+  } else {
+    if (removeDTC("P0118")) {
+      dtcStatusChanged = true;
+    }
+  }
+  
+  // Battery voltage DTC
+  if (batteryVoltage.toFloat() < 11.8) {
+    if (addDTC("P0562", "System Voltage Low")) {
+      dtcStatusChanged = true;
+    }
+    // Also trigger an alert when battery voltage is low
+    sendAlert("LOW BATTERY VOLTAGE: " + batteryVoltage + "V");
+  } else {
+    if (removeDTC("P0562")) {
+      dtcStatusChanged = true;
+    }
+  }
+  
+  // Throttle position sensor issue
+  if (throttlePosition.toInt() < 5 && speed.toInt() > 30) {
+    if (addDTC("P0123", "Throttle Position Sensor High Input")) {
+      dtcStatusChanged = true;
+    }
+  } else {
+    if (removeDTC("P0123")) {
+      dtcStatusChanged = true;
+    }
+  }
+  
+  // Set engine check light based on DTC presence
+  engineCheck = hasDTCs;
+  
+  // Only clear DTCs periodically if there's no indication to keep them
+  dtcCounter++;
+  if (dtcCounter >= 20 && !hasDTCs) {
+    clearDTCs();
+    dtcCounter = 0;
+  }
+}
+
+// Improved DTC management with return value indicating whether a change occurred
+bool addDTC(String code, String description) {
+  // Check if DTC already exists
+  for (int i = 0; i < 3; i++) {
+    if (activeDTCs[i].startsWith(code)) {
+      return false; // DTC already exists, no change
+    }
+  }
+  
+  // Find an empty slot for the DTC
+  for (int i = 0; i < 3; i++) {
+    if (activeDTCs[i] == "") {
+      activeDTCs[i] = code + ": " + description;
+      hasDTCs = true;
+      queueDTCEvent(code, true);
+      return true; // DTC added, change occurred
+    }
+  }
+  
+  return false; // No slot available, no change
+}
+
+// Improved removeDTC function with return value
+bool removeDTC(String code) {
+  for (int i = 0; i < 3; i++) {
+    if (activeDTCs[i].startsWith(code)) {
+      queueDTCEvent(code, false);
+
+      // Clear the DTC slot
+      activeDTCs[i] = "";
+      
+      // Shift remaining DTCs up to fill the gap
+      for (int j = i; j < 2; j++) {
+        activeDTCs[j] = activeDTCs[j + 1];
+      }
+      activeDTCs[2] = ""; // Clear the last slot
+      
+      // Check if any DTCs are still active
+      hasDTCs = false;
+      for (int k = 0; k < 3; k++) {
+        if (activeDTCs[k] != "") {
+          hasDTCs = true;
+          break;
+        }
+      }
+      
+      return true; // DTC was removed, change occurred
+    }
+  }
+  
+  return false; // DTC wasn't found, no change
+}
+
+void clearDTCs() {
+  for (int i = 0; i < 3; i++) {
+    activeDTCs[i] = "";
+  }
+  hasDTCs = false;
+  engineCheck = false;
+}
+
+void updateLCD(float temp) {
+    lcd.clear();
+    
+    lcd.setCursor(0,0);
+    lcd.print("RPM: ");
+    lcd.print(engineRPM);
+    
+    lcd.setCursor(9,0);
+    lcd.print("Cool: ");
+    lcd.print(temp,1);
+    
+    lcd.setCursor(0,1);
+    lcd.print("Batt: ");
+    lcd.print(batteryVoltage+"V");
+
+    lcd.setCursor(9,1);
+    lcd.print("Spd: ");
+    lcd.print(speed+"km/h");
+
+     // Display DTC warnings if there are active DTCs
+    if (BoardProfile::hasLcd && hasDTCs) {
+        delay(2000); // Show diagnostics first
+        lcd.clear();
+        lcd.setCursor(0,0);
+        lcd.print("Active DTC:");
+        
+        for (int i=0; i<3; i++) {
+            if (activeDTCs[i] != "") {
+                lcd.setCursor(0,0);
+                lcd.print("ALERT DTC:");
+                lcd.setCursor(0,1);
+                lcd.print(activeDTCs[i].substring(0,5));
+                delay(2000); // Show each DTC for a while
+            }
+        }
+        
+        delay(2000); // Return to diagnostics after showing DTCs
+    }
+}
+
+void runBuzzerTest() {
+     unsigned long currentTime = millis();
+  unsigned long elapsedTime = currentTime - buzzerTestStartTime;
+  
+  if (elapsedTime < BUZZER_TEST_DURATION) {
+    // Alternate buzzer on/off every 500ms during test period
+    if ((elapsedTime / 500) % 2 == 0) {
+      digitalWrite(BUZZER_PIN, HIGH);
+      Serial.println("Buzzer Test: ON");
+    } else {
+      digitalWrite(BUZZER_PIN, LOW);
+      Serial.println("Buzzer Test: OFF");
+    }
+    delay(500);
+  } else {
+    // End test mode after duration expires
+    buzzerTestMode = false;
+    digitalWrite(BUZZER_PIN, LOW);
+    Serial.println("Buzzer test completed. Starting regular monitoring...");
+  }
+}
+
+void sendAlert(String message) {
+    digitalWrite(BUZZER_PIN, HIGH); // Turn on buzzer during alert
+    
+    Serial.println("\n⚠️ ALERT ⚠️");
+    Serial.println(message);
+    Serial.println("Location: " + String(latitude, 6) + ", " + String(longitude, 6) +
+                   " (+/-" + String(positionFilter.errorRadiusM()) + "m)");
+    
+    delay(2000); // Keep buzzer on for alert duration
+    
+    digitalWrite(BUZZER_PIN, LOW); // Turn off buzzer after alert duration
+}
+
+// Function to send SMS using GSM module
+void sendSMS(String phoneNumber, String message) {
+    gsm.sendSMS(phoneNumber, message);
+}
+
+// Offer this cycle's values to the uplink, shedding frames while it is backlogged
+// Returns false if the frame was shed to a backlogged uplink
+bool queueTelemetry(float temp) {
+    if (uplink.backlogged() && ++uplinkSkipped % UPLINK_BACKLOG_DECIMATE != 0) {
+        return false;
+    }
+    TelemetryFrame frame;
+    frame.timeMs = millis();
+    frame.rpm = engineRPM.toInt();
+    frame.coolantDeci = (int16_t)(temp * 10);
+    frame.voltageCenti = (uint16_t)(batteryVoltage.toFloat() * 100);
+    frame.fuelPct = fuelLevel.toInt();
+    frame.speedKmh = speed.toInt();
+    frame.throttlePct = throttlePosition.toInt();
+    frame.latE7 = positionFilter.latE7Estimate();
+    frame.lonE7 = positionFilter.lonE7Estimate();
+    return uplink.offerTelemetry(frame);
+}
+
+// DTC onset/clear events always go to the uplink, packed as on the OBD-II bus
+void queueDTCEvent(String code, bool onset) {
+    if (BoardProfile::hasWifi) {
+        uint16_t packed = (uint16_t)strtol(code.c_str() + 1, NULL, 16); // P-codes: system bits are 0
+        uplink.offerDTC(millis(), packed, onset);
+    }
+}
+
+// Deep sleep discards RAM: keep the position in RTC memory and send what is queued
+void beforeDeepSleep() {
+    positionFilter.save(savedPosition);
+    endTrip();  // RAM does not survive deep sleep, so send the trip now
+    flushUplink();
+}
+
+// Deliver whatever is queued, waiting for WiFi to (re)join within UPLINK_FLUSH_MS
+void flushUplink() {
+    if (!BoardProfile::hasWifi) {
+        return;
+    }
+    uplink.flush();
+    unsigned long start = millis();
+    while (!uplink.idle() && millis() - start < UPLINK_FLUSH_MS) {
+        if (network.up()) {
+            uplink.poll(millis());
+        }
+        delay(10);
+    }
+}
+
+// Function to parse GPS data and feed fixes to the position filter.
+void updateGPS() {
+    gps.poll();
+    gpsFix = gps.hasFix();
+    if (!gps.newFix()) {
+        return;
+    }
+    bool accepted = positionFilter.updateGps(gps.latE7(), gps.lonE7());
+    if (gps.hasCourse()) {
+        positionFilter.setHeading(gps.courseCentiDeg());
+    }
+    if (debugMode) {
+        Serial.print("GPS fix: Lat: ");
+        Serial.print(gps.latE7() / 1e7, 6);
+        Serial.print(", Lng: ");
+        Serial.print(gps.lonE7() / 1e7, 6);
+        Serial.println(accepted ? "" : " (rejected)");
+    }
+}
+
+// Print driver behaviour episodes that started this cycle
+void reportDriverEvents(uint8_t events) {
+  if (events & DRIVER_EVENT_HARSH_ACCEL) Serial.println("Driver: harsh acceleration");
+  if (events & DRIVER_EVENT_HARSH_BRAKE) Serial.println("Driver: harsh braking");
+  if (events & DRIVER_EVENT_OVER_REV) Serial.println("Driver: over-revving");
+  if (events & DRIVER_EVENT_IDLING) Serial.println("Driver: excessive idling");
+  if (events & DRIVER_EVENT_SPEEDING) Serial.println("Driver: speeding");
+}
+
+// Report the finished trip's score and counters, then start a new trip
+void endTrip() {
+  const DriverTripStats& t = driverBehavior.trip();
+  if (t.durationMs > 0) {
+    Serial.print("Trip: ");
+    Serial.print(t.distanceM / 1000.0, 1);
+    Serial.print(" km in ");
+    Serial.print(t.durationMs / 60000);
+    Serial.print(" min, score ");
+    Serial.println(driverBehavior.score());
+
+    if (BoardProfile::hasWifi) {
+      TripRecord record = TripRecord();
+      record.durationS = t.durationMs / 1000;
+      record.drivingS = t.drivingMs / 1000;
+      record.idleS = t.idleMs / 1000;
+      record.overRevS = t.overRevMs / 1000;
+      record.speedingS = t.speedingMs / 1000;
+      record.distanceM = t.distanceM;
+      record.harshAccelCount = (uint16_t)(t.harshAccelCount < 0xFFFF ? t.harshAccelCount : 0xFFFF);
+      record.harshBrakeCount = (uint16_t)(t.harshBrakeCount < 0xFFFF ? t.harshBrakeCount : 0xFFFF);
+      record.overRevCount = (uint16_t)(t.overRevCount < 0xFFFF ? t.overRevCount : 0xFFFF);
+      record.idleCount = (uint16_t)(t.idleCount < 0xFFFF ? t.idleCount : 0xFFFF);
+      record.speedingCount = (uint16_t)(t.speedingCount < 0xFFFF ? t.speedingCount : 0xFFFF);
+      record.score = driverBehavior.score();
+      uplink.offerTrip(millis(), record);
+    }
+  }
+  driverBehavior.startTrip();
+}
+
+void displayEnhancedDashboard(float temp) {
+   Serial.println("\n┌─────────────────────────────────┐");
+  Serial.println("│      VEHICLE DIAGNOSTICS        │");
+  Serial.println("├─────────────────────────────────┤");
+  
+  Serial.print("│ RPM: ");
+  Serial.print(engineRPM);
+  printSpaces(13 - engineRPM.length());
+  Serial.print("│ Coolant: ");
+  String tempStr = String(temp, 1) + "°C";
+  Serial.print(tempStr);
+  printSpaces(11 - tempStr.length());
+  Serial.println("│");
+  
+  Serial.print("│ Throttle: ");
+  Serial.print(throttlePosition + "%");
+  printSpaces(8 - throttlePosition.length());
+  Serial.print("│ Battery: ");
+  Serial.print(batteryVoltage + "V");
+  printSpaces(11 - batteryVoltage.length());
+  Serial.println("│");
+  
+  Serial.print("│ Fuel: ");
+  Serial.print(fuelLevel + "%");
+  printSpaces(11 - fuelLevel.length());
+  Serial.print("│ Speed: ");
+  Serial.print(speed + " km/h");
+  printSpaces(11 - speed.length());
+  Serial.println("│");
+  
+  Serial.println("├────────────────┴────────────────┤");
+  Serial.println("│ DIAGNOSTIC STATUS               │");
+  Serial.println("├─────────────────────────────────┤");
+  Serial.print("│ Check Engine: ");
+  Serial.print(engineCheck ? "ON " : "OFF");
+  printSpaces(17);
+  Serial.println("│");
+
+  Serial.print("│ Driver Score: ");
+  String scoreStr = String(driverBehavior.score());
+  Serial.print(scoreStr);
+  printSpaces(18 - scoreStr.length());
+  Serial.println("│");
+  
+  Serial.print("│ Temp Status: ");
+  if (temp > 40.0) {
+    Serial.print("CRITICAL");
+    printSpaces(11);
+  } else if (temp > 30.0) {
+    Serial.print("WARNING");
+    printSpaces(13);
+  } else if (temp > 20.0) {
+    Serial.print("NORMAL");
+    printSpaces(14);
+  } else {
+    Serial.print("COLD");
+    printSpaces(16);
+  }
+  Serial.println("│");
+  
+  Serial.println("└─────────────────────────────────┘");
+}
+
+void displayDTCs() {
+    Serial.println("\n┌─────────────────────────────────┐");
+  Serial.println("│ DIAGNOSTIC TROUBLE CODES        │");
+  Serial.println("├─────────────────────────────────┤");
+  
+  bool hasPrinted = false;
+  
+  for (int i = 0; i < 3; i++) {
+    if (activeDTCs[i] != "") {
+      hasPrinted = true;
+      Serial.print("│ ");
+      Serial.print(activeDTCs[i]);
+      printSpaces(31 - activeDTCs[i].length());
+      Serial.println("│");
+    }
+  }
+  
+  if (!hasPrinted) {
+    Serial.println("│ No active DTCs                   │");
+  }
+  
+  Serial.println("└─────────────────────────────────┘");
+}
+
+void printSpaces(int count) {
+  if (count < 0) count = 0; // Safety check
+  for (int i = 0; i < count; i++) {
+    Serial.print(" ");
+  }
+}
+
+#endif
@@ -0,0 +1,760 @@
+#ifndef UPLINK_H
+#define UPLINK_H
+
+// Batched cloud uplink over a persistent MQTT connection.
+// Telemetry frames, DTC events, memory samples and trip summaries are appended to a batch
+// as delta + varint records (about 12 bytes per telemetry frame instead of
+// a request per loop). A batch is published when it is full or
+// UPLINK_BATCH_MS old, as an MQTT 3.1.1 QoS 1 message, and is kept until
+// the broker's PUBACK arrives; unacknowledged batches are resent with DUP
+// after a timeout or a reconnect. All buffers are static. When every batch
+// slot is in use offerTelemetry() and offerMemory() fail and backlogged()
+// reports it, so the producer can shed load instead of blocking. DTC events
+// are held in a small queue of their own until a slot frees, and the last
+// trip summary likewise, so a backlog sheds telemetry rather than fault
+// reports or trip scores.
+//
+// ClientT is anything with the Arduino Client calls used below
+// (connect, connected, write, available, read, stop), e.g. WiFiClient, or
+// backend/PosixClient.h on Linux. Time is passed in, so the same code runs
+// against the mock broker in backend/. UPLINK_USERNAME and UPLINK_PASSWORD,
+// if defined, are sent in CONNECT; TLS is up to ClientT (see NetworkLink).
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef UPLINK_BROKER_HOST
+#define UPLINK_BROKER_HOST      "localhost"   // Host tools; boards set theirs in BoardProfile.h
+#endif
+#ifndef UPLINK_BROKER_PORT
+#define UPLINK_BROKER_PORT      1883
+#endif
+#ifndef UPLINK_DEVICE_ID
+#define UPLINK_DEVICE_ID        "smarttrack-001"
+#endif
+#ifndef UPLINK_BATCH_BYTES
+#define UPLINK_BATCH_BYTES      512     // Payload bytes per batch
+#endif
+#ifndef UPLINK_BATCH_MS
+#define UPLINK_BATCH_MS         30000   // Publish a partial batch after 30 seconds
+#endif
+#ifndef UPLINK_QUEUE_SLOTS
+#define UPLINK_QUEUE_SLOTS      4       // Batches buffered while the link is slow or down
+#endif
+#define UPLINK_DTC_PENDING      8       // DTC events held while every batch slot is busy
+#define UPLINK_MAX_INFLIGHT     2       // Unacknowledged publishes at once
+#define UPLINK_ACK_TIMEOUT_MS   10000   // Resend a publish not acknowledged in time
+#define UPLINK_KEEPALIVE_S      60
+#define UPLINK_RECONNECT_MIN_MS 1000
+#define UPLINK_RECONNECT_MAX_MS 60000
+
+#define UPLINK_TOPIC "smarttrack/" UPLINK_DEVICE_ID "/batch"
+
+// Batch payload: version byte, start time varint, then records of
+// { type byte, time delta varint, fields }. Telemetry fields are zigzag
+// varint deltas from the previous telemetry record in the batch.
+// Memory fields are free heap, largest block, minimum free heap,
+// fragmentation %, a stack count and that many stack high-water marks.
+// Trip fields are duration, driving, idle, over-rev and speeding seconds,
+// distance in metres, the five event counts and the score.
+#define UPLINK_FORMAT_VERSION   3
+#define UPLINK_REC_TELEMETRY    1
+#define UPLINK_REC_DTC_ONSET    2
+#define UPLINK_REC_DTC_CLEAR    3
+#define UPLINK_REC_MEMORY       4
+#define UPLINK_REC_TRIP         5
+#define UPLINK_MAX_STACKS       4       // Stack high-water marks per memory record
+#define UPLINK_MAX_RECORD_BYTES 56      // Worst-case encoded record (memory with every stack)
+
+struct TelemetryFrame {
+  uint32_t timeMs;
+  uint16_t rpm;
+  int16_t coolantDeci;      // 0.1 degC
+  uint16_t voltageCenti;    // 0.01 V
+  uint8_t fuelPct;
+  uint8_t speedKmh;
+  uint8_t throttlePct;
+  int32_t latE7;
+  int32_t lonE7;
+};
+
+// Heap and stack sample, as MemoryTelemetry reports it
+struct MemoryRecord {
+  uint32_t freeHeap;
+  uint32_t largestBlock;
+  uint32_t minFreeHeap;
+  uint8_t fragmentationPct;
+  uint8_t stackCount;
+  uint32_t stackHighWater[UPLINK_MAX_STACKS];   // Bytes, in task registration order (loop task first)
+};
+
+// Summary of a finished trip, as DriverBehavior scored it
+struct TripRecord {
+  uint32_t durationS;
+  uint32_t drivingS;
+  uint32_t idleS;
+  uint32_t overRevS;
+  uint32_t speedingS;
+  uint32_t distanceM;
+  uint16_t harshAccelCount;
+  uint16_t harshBrakeCount;
+  uint16_t overRevCount;
+  uint16_t idleCount;
+  uint16_t speedingCount;
+  uint8_t score;            // 0 (worst) .. 100
+};
+
+inline uint32_t uplinkZigzag(int32_t v) {
+  return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+inline int32_t uplinkUnzigzag(uint32_t v) {
+  return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+inline size_t uplinkPutVarint(uint8_t* p, uint32_t v) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    p[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  p[n++] = (uint8_t)v;
+  return n;
+}
+
+inline bool uplinkGetVarint(const uint8_t*& p, const uint8_t* end, uint32_t& v) {
+  v = 0;
+  for (int shift = 0; shift < 35 && p < end; shift += 7) {
+    uint8_t b = *p++;
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+// One batch payload being filled
+class UplinkBatch {
+public:
+  void start(uint32_t nowMs) {
+    len = 0;
+    count = 0;
+    startMs = nowMs;
+    lastMs = nowMs;
+    memset(&prev, 0, sizeof(prev));
+    buf[len++] = UPLINK_FORMAT_VERSION;
+    len += uplinkPutVarint(buf + len, nowMs);
+  }
+
+  // Each add returns false if the record does not fit; the batch is unchanged
+  bool addTelemetry(const TelemetryFrame& f) {
+    if (!room()) return false;
+    putHeader(UPLINK_REC_TELEMETRY, f.timeMs);
+    putDelta(f.rpm, prev.rpm);
+    putDelta(f.coolantDeci, prev.coolantDeci);
+    putDelta(f.voltageCenti, prev.voltageCenti);
+    putDelta(f.fuelPct, prev.fuelPct);
+    putDelta(f.speedKmh, prev.speedKmh);
+    putDelta(f.throttlePct, prev.throttlePct);
+    putDelta(f.latE7, prev.latE7);
+    putDelta(f.lonE7, prev.lonE7);
+    prev = f;
+    return true;
+  }
+
+  bool addDTC(uint32_t timeMs, uint16_t code, bool onset) {
+    if (!room()) return false;
+    putHeader(onset ? UPLINK_REC_DTC_ONSET : UPLINK_REC_DTC_CLEAR, timeMs);
+    len += uplinkPutVarint(buf + len, code);
+    return true;
+  }
+
+  bool addMemory(uint32_t timeMs, const MemoryRecord& m) {
+    if (!room()) return false;
+    putHeader(UPLINK_REC_MEMORY, timeMs);
+    uint8_t stacks = m.stackCount < UPLINK_MAX_STACKS ? m.stackCount : UPLINK_MAX_STACKS;
+    len += uplinkPutVarint(buf + len, m.freeHeap);
+    len += uplinkPutVarint(buf + len, m.largestBlock);
+    len += uplinkPutVarint(buf + len, m.minFreeHeap);
+    len += uplinkPutVarint(buf + len, m.fragmentationPct);
+    len += uplinkPutVarint(buf + len, stacks);
+    for (uint8_t i = 0; i < stacks; i++) {
+      len += uplinkPutVarint(buf + len, m.stackHighWater[i]);
+    }
+    return true;
+  }
+
+  bool addTrip(uint32_t timeMs, const TripRecord& t) {
+    if (!room()) return false;
+    putHeader(UPLINK_REC_TRIP, timeMs);
+    const uint32_t fields[12] = {t.durationS, t.drivingS, t.idleS, t.overRevS, t.speedingS, t.distanceM,
+                                 t.harshAccelCount, t.harshBrakeCount, t.overRevCount, t.idleCount,
+                                 t.speedingCount, t.score};
+    for (uint8_t i = 0; i < 12; i++) {
+      len += uplinkPutVarint(buf + len, fields[i]);
+    }
+    return true;
+  }
+
+  const uint8_t* data() const { return buf; }
+  size_t size() const { return len; }
+  uint16_t records() const { return count; }
+  uint32_t startedMs() const { return startMs; }
+
+private:
+  bool room() const {
+    return len + UPLINK_MAX_RECORD_BYTES <= UPLINK_BATCH_BYTES;
+  }
+
+  void putHeader(uint8_t type, uint32_t timeMs) {
+    buf[len++] = type;
+    len += uplinkPutVarint(buf + len, timeMs - lastMs);
+    lastMs = timeMs;
+    count++;
+  }
+
+  void putDelta(int32_t value, int32_t previous) {
+    len += uplinkPutVarint(buf + len, uplinkZigzag(value - previous));
+  }
+
+  uint8_t buf[UPLINK_BATCH_BYTES];
+  size_t len;
+  uint16_t count;
+  uint32_t startMs;
+  uint32_t lastMs;
+  TelemetryFrame prev;
+};
+
+// Decoded batch record
+struct UplinkRecord {
+  uint8_t type;
+  uint32_t timeMs;
+  TelemetryFrame telemetry;   // UPLINK_REC_TELEMETRY
+  uint16_t dtcCode;           // UPLINK_REC_DTC_ONSET / UPLINK_REC_DTC_CLEAR
+  MemoryRecord memory;        // UPLINK_REC_MEMORY
+  TripRecord trip;            // UPLINK_REC_TRIP
+};
+
+// Walks the records of a received batch payload
+class UplinkBatchReader {
+public:
+  UplinkBatchReader(const uint8_t* data, size_t size) : p(data), end(data + size), ok(false) {
+    memset(&prev, 0, sizeof(prev));
+    uint32_t start;
+    if (p < end && *p++ == UPLINK_FORMAT_VERSION && uplinkGetVarint(p, end, start)) {
+      lastMs = start;
+      ok = true;
+    }
+  }
+
+  // False at the end of the batch or on a malformed record
+  bool next(UplinkRecord& r) {
+    if (!ok || p >= end) return false;
+    uint32_t dt;
+    r.type = *p++;
+    if (!uplinkGetVarint(p, end, dt)) return ok = false;
+    lastMs += dt;
+    r.timeMs = lastMs;
+
+    uint32_t v[12];
+    int fields = r.type == UPLINK_REC_TELEMETRY ? 8 : r.type == UPLINK_REC_MEMORY ? 5
+               : r.type == UPLINK_REC_TRIP ? 12 : 1;
+    if (r.type < UPLINK_REC_TELEMETRY || r.type > UPLINK_REC_TRIP) return ok = false;
+    for (int i = 0; i < fields; i++) {
+      if (!uplinkGetVarint(p, end, v[i])) return ok = false;
+    }
+
+    if (r.type == UPLINK_REC_TELEMETRY) {
+      TelemetryFrame& f = r.telemetry;
+      f.timeMs = r.timeMs;
+      f.rpm = (uint16_t)(prev.rpm + uplinkUnzigzag(v[0]));
+      f.coolantDeci = (int16_t)(prev.coolantDeci + uplinkUnzigzag(v[1]));
+      f.voltageCenti = (uint16_t)(prev.voltageCenti + uplinkUnzigzag(v[2]));
+      f.fuelPct = (uint8_t)(prev.fuelPct + uplinkUnzigzag(v[3]));
+      f.speedKmh = (uint8_t)(prev.speedKmh + uplinkUnzigzag(v[4]));
+      f.throttlePct = (uint8_t)(prev.throttlePct + uplinkUnzigzag(v[5]));
+      f.latE7 = prev.latE7 + uplinkUnzigzag(v[6]);
+      f.lonE7 = prev.lonE7 + uplinkUnzigzag(v[7]);
+      prev = f;
+    } else if (r.type == UPLINK_REC_MEMORY) {
+      MemoryRecord& m = r.memory;
+      if (v[3] > 100 || v[4] > UPLINK_MAX_STACKS) return ok = false;
+      m.freeHeap = v[0];
+      m.largestBlock = v[1];
+      m.minFreeHeap = v[2];
+      m.fragmentationPct = (uint8_t)v[3];
+      m.stackCount = (uint8_t)v[4];
+      for (uint8_t i = 0; i < m.stackCount; i++) {
+        if (!uplinkGetVarint(p, end, m.stackHighWater[i])) return ok = false;
+      }
+    } else if (r.type == UPLINK_REC_TRIP) {
+      TripRecord& t = r.trip;
+      if (v[11] > 100) return ok = false;
+      t.durationS = v[0];
+      t.drivingS = v[1];
+      t.idleS = v[2];
+      t.overRevS = v[3];
+      t.speedingS = v[4];
+      t.distanceM = v[5];
+      t.harshAccelCount = (uint16_t)v[6];
+      t.harshBrakeCount = (uint16_t)v[7];
+      t.overRevCount = (uint16_t)v[8];
+      t.idleCount = (uint16_t)v[9];
+      t.speedingCount = (uint16_t)v[10];
+      t.score = (uint8_t)v[11];
+    } else {
+      r.dtcCode = (uint16_t)v[0];
+    }
+    return true;
+  }
+
+  bool valid() const { return ok; }
+
+private:
+  const uint8_t* p;
+  const uint8_t* end;
+  bool ok;
+  uint32_t lastMs;
+  TelemetryFrame prev;
+};
+
+struct UplinkStats {
+  uint32_t batchesAcked;
+  uint32_t recordsAcked;
+  uint32_t recordsDropped;    // Refused by back-pressure (DTC events only once UPLINK_DTC_PENDING are held)
+  uint32_t resends;
+  uint32_t reconnects;
+  uint32_t refused;           // CONNACKs with an error, e.g. bad user name or password
+  uint32_t bytesSent;         // MQTT bytes including headers and resends
+};
+
+template <typename ClientT>
+class Uplink {
+public:
+  explicit Uplink(ClientT& client) : client(client) {
+    memset(&stats_, 0, sizeof(stats_));
+    for (uint8_t i = 0; i < UPLINK_QUEUE_SLOTS; i++) slots[i].state = SLOT_FREE;
+    filling = -1;
+    nextSeq = 0;
+    nextPacketId = 1;
+    state = LINK_DISCONNECTED;
+    everConnected = false;
+    backoffMs = UPLINK_RECONNECT_MIN_MS;
+    lastAttemptMs = 0;
+    attempted = false;
+    lastSendMs = 0;
+    dtcHead = 0;
+    dtcCount = 0;
+    tripHeld = false;
+    resetReader();
+  }
+
+  bool offerTelemetry(const TelemetryFrame& f) {
+    drainDTCs(f.timeMs);
+    Slot* s = fillingSlot(f.timeMs);
+    if (s && !s->batch.addTelemetry(f)) {
+      seal();
+      s = fillingSlot(f.timeMs);
+      if (s && !s->batch.addTelemetry(f)) s = 0;
+    }
+    return accepted(s);
+  }
+
+  // Queued behind earlier DTC events and moved into a batch as soon as a
+  // slot is free; fails only when UPLINK_DTC_PENDING events are waiting
+  bool offerDTC(uint32_t nowMs, uint16_t code, bool onset) {
+    if (dtcCount == UPLINK_DTC_PENDING) return accepted(0);
+    PendingDTC& d = dtcPending[(dtcHead + dtcCount) % UPLINK_DTC_PENDING];
+    d.timeMs = nowMs;
+    d.code = code;
+    d.onset = onset;
+    dtcCount++;
+    drainDTCs(nowMs);
+    return true;
+  }
+
+  // Held until a slot is free, like a DTC event; a newer trip replaces one
+  // still waiting
+  void offerTrip(uint32_t nowMs, const TripRecord& t) {
+    heldTrip = t;
+    heldTripMs = nowMs;
+    tripHeld = true;
+    drainDTCs(nowMs);
+  }
+
+  bool offerMemory(uint32_t nowMs, const MemoryRecord& m) {
+    drainDTCs(nowMs);
+    Slot* s = fillingSlot(nowMs);
+    if (s && !s->batch.addMemory(nowMs, m)) {
+      seal();
+      s = fillingSlot(nowMs);
+      if (s && !s->batch.addMemory(nowMs, m)) s = 0;
+    }
+    return accepted(s);
+  }
+
+  // True when no batch slot is free: the producer should shed load
+  bool backlogged() const {
+    for (uint8_t i = 0; i < UPLINK_QUEUE_SLOTS; i++) {
+      if (slots[i].state == SLOT_FREE) return false;
+    }
+    return true;
+  }
+
+  bool connected() const {
+    return state == LINK_CONNECTED;
+  }
+
+  // Seal the partial batch so the next poll() publishes it
+  void flush() {
+    if (filling >= 0 && slots[filling].batch.records() > 0) seal();
+  }
+
+  // True when nothing is queued or waiting for an ack
+  bool idle() const {
+    if (dtcCount > 0 || tripHeld) return false;
+    for (uint8_t i = 0; i < UPLINK_QUEUE_SLOTS; i++) {
+      const Slot& s = slots[i];
+      if (s.state == SLOT_READY || s.state == SLOT_INFLIGHT) return false;
+      if (s.state == SLOT_FILLING && s.batch.records() > 0) return false;
+    }
+    return true;
+  }
+
+  const UplinkStats& stats() const {
+    return stats_;
+  }
+
+  // Drive the connection: seal due batches, (re)connect, read acks, publish, resend
+  void poll(uint32_t nowMs) {
+    drainDTCs(nowMs);
+    if (filling >= 0 && slots[filling].batch.records() > 0 &&
+        nowMs - slots[filling].batch.startedMs() >= UPLINK_BATCH_MS) {
+      seal();
+    }
+
+    if (state == LINK_DISCONNECTED) {
+      if (attempted && nowMs - lastAttemptMs < backoffMs) return;
+      attempted = true;
+      lastAttemptMs = nowMs;
+      if (!client.connect(UPLINK_BROKER_HOST, UPLINK_BROKER_PORT) || !sendConnect(nowMs)) {
+        client.stop();
+        backoffMs = backoffMs * 2 > UPLINK_RECONNECT_MAX_MS ? UPLINK_RECONNECT_MAX_MS : backoffMs * 2;
+        return;
+      }
+      state = LINK_AWAIT_CONNACK;
+    }
+
+    if (!client.connected()) {
+      disconnect(nowMs);
+      return;
+    }
+    readPackets(nowMs);
+
+    if (state == LINK_AWAIT_CONNACK) {
+      if (nowMs - lastAttemptMs >= UPLINK_ACK_TIMEOUT_MS) disconnect(nowMs);
+      return;
+    }
+    if (state != LINK_CONNECTED) return;
+
+    // Resend publishes whose PUBACK is overdue
+    for (uint8_t i = 0; i < UPLINK_QUEUE_SLOTS; i++) {
+      Slot& s = slots[i];
+      if (s.state == SLOT_INFLIGHT && nowMs - s.sentMs >= UPLINK_ACK_TIMEOUT_MS) {
+        if (!publish(s, true, nowMs)) return;
+        stats_.resends++;
+      }
+    }
+
+    // Publish ready batches in order while the window allows
+    while (inflightCount() < UPLINK_MAX_INFLIGHT) {
+      Slot* s = oldestReady();
+      if (!s) break;
+      if (!publish(*s, s->dup, nowMs)) return;
+    }
+
+    if (nowMs - lastSendMs >= UPLINK_KEEPALIVE_S * 1000UL / 2) {
+      const uint8_t ping[2] = {0xC0, 0x00};
+      if (!send(ping, sizeof(ping), nowMs)) return;
+    }
+  }
+
+private:
+  enum SlotState { SLOT_FREE, SLOT_FILLING, SLOT_READY, SLOT_INFLIGHT };
+  enum LinkState { LINK_DISCONNECTED, LINK_AWAIT_CONNACK, LINK_CONNECTED };
+
+  struct Slot {
+    UplinkBatch batch;
+    uint8_t state;
+    bool dup;
+    uint16_t packetId;
+    uint32_t seq;
+    uint32_t sentMs;
+  };
+
+  struct PendingDTC {
+    uint32_t timeMs;
+    uint16_t code;
+    bool onset;
+  };
+
+  Slot* fillingSlot(uint32_t nowMs) {
+    if (filling >= 0) return &slots[filling];
+    for (uint8_t i = 0; i < UPLINK_QUEUE_SLOTS; i++) {
+      if (slots[i].state == SLOT_FREE) {
+        slots[i].state = SLOT_FILLING;
+        // Held records go first, so start the batch at the oldest of them
+        uint32_t startMs = nowMs;
+        if (tripHeld) startMs = heldTripMs;
+        if (dtcCount > 0 && (!tripHeld || (int32_t)(dtcPending[dtcHead].timeMs - startMs) < 0)) {
+          startMs = dtcPending[dtcHead].timeMs;
+        }
+        slots[i].batch.start(startMs);
+        filling = i;
+        return &slots[i];
+      }
+    }
+    return 0;
+  }
+
+  // Move held DTC events and the held trip into batches, oldest first,
+  // while a slot is available
+  void drainDTCs(uint32_t nowMs) {
+    while (dtcCount > 0 || tripHeld) {
+      Slot* s = fillingSlot(nowMs);
+      if (!s) return;
+      bool tripFirst = tripHeld && (dtcCount == 0 || (int32_t)(heldTripMs - dtcPending[dtcHead].timeMs) < 0);
+      if (tripFirst) {
+        if (!s->batch.addTrip(heldTripMs, heldTrip)) {
+          seal();
+          continue;
+        }
+        tripHeld = false;
+        continue;
+      }
+      const PendingDTC& d = dtcPending[dtcHead];
+      if (!s->batch.addDTC(d.timeMs, d.code, d.onset)) {
+        seal();
+        continue;
+      }
+      dtcHead = (uint8_t)((dtcHead + 1) % UPLINK_DTC_PENDING);
+      dtcCount--;
+    }
+  }
+
+  bool accepted(Slot* s) {
+    if (s) return true;
+    stats_.recordsDropped++;
+    return false;
+  }
+
+  void seal() {
+    if (filling < 0) return;
+    Slot& s = slots[filling];
+    s.state = SLOT_READY;
+    s.dup = false;
+    s.seq = nextSeq++;
+    filling = -1;
+  }
+
+  Slot* oldestReady() {
+    Slot* best = 0;
+    for (uint8_t i = 0; i < UPLINK_QUEUE_SLOTS; i++) {
+      if (slots[i].state == SLOT_READY && (!best || (int32_t)(slots[i].seq - best->seq) < 0)) {
+        best = &slots[i];
+      }
+    }
+    return best;
+  }
+
+  uint8_t inflightCount() const {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < UPLINK_QUEUE_SLOTS; i++) {
+      if (slots[i].state == SLOT_INFLIGHT) n++;
+    }
+    return n;
+  }
+
+  static size_t putRemainingLength(uint8_t* p, uint32_t len) {
+    return uplinkPutVarint(p, len);  // MQTT uses the same 7-bit encoding
+  }
+
+  bool send(const uint8_t* data, size_t len, uint32_t nowMs) {
+    if (client.write(data, len) != len) {
+      disconnect(nowMs);
+      return false;
+    }
+    stats_.bytesSent += len;
+    lastSendMs = nowMs;
+    return true;
+  }
+
+  bool sendConnect(uint32_t nowMs) {
+    static const char clientId[] = UPLINK_DEVICE_ID;
+#ifdef UPLINK_USERNAME
+    static const char username[] = UPLINK_USERNAME;
+#else
+    static const char username[] = "";
+#endif
+#ifdef UPLINK_PASSWORD
+    static const char password[] = UPLINK_PASSWORD;
+#else
+    static const char password[] = "";
+#endif
+    // MQTT 3.1.1 allows a password only after a user name
+    const bool hasUser = sizeof(username) > 1;
+    const bool hasPassword = hasUser && sizeof(password) > 1;
+    const uint8_t flags = (uint8_t)(0x02 | (hasUser ? 0x80 : 0) | (hasPassword ? 0x40 : 0));   // Clean session
+
+    uint8_t packet[20 + sizeof(clientId) + sizeof(username) + sizeof(password)];
+    size_t n = 0;
+    packet[n++] = 0x10;
+    n += putRemainingLength(packet + n, 10 + 2 + (uint32_t)sizeof(clientId) - 1 +
+                            (hasUser ? 2 + (uint32_t)sizeof(username) - 1 : 0) +
+                            (hasPassword ? 2 + (uint32_t)sizeof(password) - 1 : 0));
+    const uint8_t header[10] = {0, 4, 'M', 'Q', 'T', 'T', 4, flags,   // Level 4
+                                (uint8_t)(UPLINK_KEEPALIVE_S >> 8), (uint8_t)(UPLINK_KEEPALIVE_S & 0xFF)};
+    memcpy(packet + n, header, sizeof(header));
+    n += sizeof(header);
+    n += putString(packet + n, clientId, sizeof(clientId) - 1);
+    if (hasUser) n += putString(packet + n, username, sizeof(username) - 1);
+    if (hasPassword) n += putString(packet + n, password, sizeof(password) - 1);
+    resetReader();
+    return send(packet, n, nowMs);
+  }
+
+  static size_t putString(uint8_t* out, const char* s, uint16_t len) {
+    out[0] = (uint8_t)(len >> 8);
+    out[1] = (uint8_t)(len & 0xFF);
+    memcpy(out + 2, s, len);
+    return 2 + (size_t)len;
+  }
+
+  bool publish(Slot& s, bool dup, uint32_t nowMs) {
+    if (!dup) {
+      s.packetId = nextPacketId++;
+      if (nextPacketId == 0) nextPacketId = 1;
+    }
+    static const char topic[] = UPLINK_TOPIC;
+    const uint16_t topicLen = sizeof(topic) - 1;
+
+    uint8_t header[8 + sizeof(topic)];
+    size_t n = 0;
+    header[n++] = (uint8_t)(0x32 | (dup ? 0x08 : 0));   // PUBLISH, QoS 1
+    n += putRemainingLength(header + n, 2 + topicLen + 2 + (uint32_t)s.batch.size());
+    header[n++] = (uint8_t)(topicLen >> 8);
+    header[n++] = (uint8_t)(topicLen & 0xFF);
+    memcpy(header + n, topic, topicLen);
+    n += topicLen;
+    header[n++] = (uint8_t)(s.packetId >> 8);
+    header[n++] = (uint8_t)(s.packetId & 0xFF);
+
+    if (!send(header, n, nowMs) || !send(s.batch.data(), s.batch.size(), nowMs)) return false;
+    s.state = SLOT_INFLIGHT;
+    s.dup = true;   // Any later send of this batch is a redelivery
+    s.sentMs = nowMs;
+    return true;
+  }
+
+  void disconnect(uint32_t nowMs) {
+    client.stop();
+    state = LINK_DISCONNECTED;
+    lastAttemptMs = nowMs;
+    attempted = true;
+    // Unacknowledged batches go back to the queue and are resent with DUP set
+    for (uint8_t i = 0; i < UPLINK_QUEUE_SLOTS; i++) {
+      if (slots[i].state == SLOT_INFLIGHT) slots[i].state = SLOT_READY;
+    }
+  }
+
+  void resetReader() {
+    rxStage = 0;
+    rxLength = 0;
+    rxShift = 0;
+    rxCount = 0;
+  }
+
+  // Incremental parser for the short packets a broker sends to a publisher
+  void readPackets(uint32_t nowMs) {
+    while (client.available() > 0) {
+      int c = client.read();
+      if (c < 0) break;
+      uint8_t b = (uint8_t)c;
+
+      if (rxStage == 0) {
+        rxType = b;
+        rxLength = 0;
+        rxShift = 0;
+        rxCount = 0;
+        rxStage = 1;
+        continue;
+      }
+      if (rxStage == 1) {
+        rxLength |= (uint32_t)(b & 0x7F) << rxShift;
+        rxShift += 7;
+        if (b & 0x80) continue;
+        rxStage = 2;
+        if (rxLength > 0) continue;
+      } else {
+        if (rxCount < sizeof(rxBody)) rxBody[rxCount] = b;
+        rxCount++;
+        if (rxCount < rxLength) continue;
+      }
+      handlePacket(nowMs);
+      resetReader();
+    }
+  }
+
+  void handlePacket(uint32_t nowMs) {
+    uint8_t type = rxType >> 4;
+    if (type == 2 && rxLength >= 2) {          // CONNACK
+      if (rxBody[1] != 0) {
+        stats_.refused++;
+        disconnect(nowMs);
+        return;
+      }
+      if (everConnected) stats_.reconnects++;
+      everConnected = true;
+      state = LINK_CONNECTED;
+      backoffMs = UPLINK_RECONNECT_MIN_MS;
+    } else if (type == 4 && rxLength >= 2) {   // PUBACK
+      uint16_t id = (uint16_t)(rxBody[0] << 8 | rxBody[1]);
+      for (uint8_t i = 0; i < UPLINK_QUEUE_SLOTS; i++) {
+        Slot& s = slots[i];
+        if (s.state == SLOT_INFLIGHT && s.packetId == id) {
+          stats_.batchesAcked++;
+          stats_.recordsAcked += s.batch.records();
+          s.state = SLOT_FREE;
+        }
+      }
+    }
+    // PINGRESP and anything else need no action
+  }
+
+  ClientT& client;
+  Slot slots[UPLINK_QUEUE_SLOTS];
+  int8_t filling;
+  uint32_t nextSeq;
+  uint16_t nextPacketId;
+  uint8_t state;
+  bool everConnected;
+  uint32_t backoffMs;
+  uint32_t lastAttemptMs;
+  bool attempted;
+  uint32_t lastSendMs;
+  UplinkStats stats_;
+  PendingDTC dtcPending[UPLINK_DTC_PENDING];
+  uint8_t dtcHead;
+  uint8_t dtcCount;
+  TripRecord heldTrip;
+  uint32_t heldTripMs;
+  bool tripHeld;
+
+  uint8_t rxStage;
+  uint8_t rxType;
+  uint32_t rxLength;
+  uint8_t rxShift;
+  uint32_t rxCount;
+  uint8_t rxBody[4];
+};
+
+#endif